@@ -48,6 +48,10 @@
 #define CMD_READ_SECTOR_RETRY 0x20      /* READ SECTOR with retries. */
 #define CMD_WRITE_SECTOR_RETRY 0x30     /* WRITE SECTOR with retries. */
 
+/* Ticks to wait for a command's completion interrupt before
+   giving it up as lost. */
+#define DISK_TIMEOUT TIMER_FREQ
+
 /* An ATA device. */
 struct disk {
 	char name[8];               /* Name, e.g. "hd0:1". */
@@ -90,6 +94,7 @@ static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
 
 static void wait_until_idle (const struct disk *);
+static void wait_for_interrupt (struct channel *);
 static bool wait_while_busy (const struct disk *);
 static void select_device (const struct disk *);
 static void select_device_wait (const struct disk *);
@@ -218,7 +223,7 @@ disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) {
 	lock_acquire (&c->lock);
 	select_sector (d, sec_no);
 	issue_pio_command (c, CMD_READ_SECTOR_RETRY);
-	sema_down (&c->completion_wait);
+	wait_for_interrupt (c);
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name, sec_no);
 	input_sector (c, buffer);
@@ -245,7 +250,7 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
 	output_sector (c, buffer);
-	sema_down (&c->completion_wait);
+	wait_for_interrupt (c);
 	d->write_cnt++;
 	lock_release (&c->lock);
 }
@@ -354,7 +359,7 @@ identify_ata_device (struct disk *d) {
 	   into our buffer. */
 	select_device_wait (d);
 	issue_pio_command (c, CMD_IDENTIFY_DEVICE);
-	sema_down (&c->completion_wait);
+	wait_for_interrupt (c);
 	if (!wait_while_busy (d)) {
 		d->is_ata = false;
 		return;
@@ -511,6 +516,24 @@ select_device_wait (const struct disk *d) {
 	wait_until_idle (d);
 }
 
+/* Waits for the interrupt that completes the command just issued
+   on channel C.  If it has not come in DISK_TIMEOUT ticks, it is
+   taken to be lost: the caller goes on to poll the status
+   register as usual, and a late interrupt is ignored. */
+static void
+wait_for_interrupt (struct channel *c) {
+	enum intr_level old_level;
+
+	if (sema_down_timeout (&c->completion_wait, DISK_TIMEOUT))
+		return;
+
+	old_level = intr_disable ();
+	c->expecting_interrupt = false;
+	sema_try_down (&c->completion_wait);
+	intr_set_level (old_level);
+	printf ("%s: lost interrupt, polling\n", c->name);
+}
+
 /* ATA interrupt handler. */
 static void
 interrupt_handler (struct intr_frame *f) {
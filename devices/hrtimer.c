@@ -0,0 +1,235 @@
+#include "devices/hrtimer.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/lapic.h"
+#include "threads/thread.h"
+
+/* High-resolution timers.
+
+   Pending timers are kept in a red-black tree ordered by expiry,
+   in nanoseconds of timer_now_ns().  When the CPU has a local
+   APIC, its timer serves as a one-shot clock-event device: it is
+   always armed for the earliest pending timer, and its interrupt
+   runs every timer that has expired and re-arms it for the next.
+   Otherwise the PIT's periodic tick stands in, and timers fire at
+   the first tick at or after their expiry.
+
+   Callbacks run with interrupts off, usually in an external
+   interrupt, so like timer_event callbacks they may wake threads
+   but not sleep. */
+
+/* Local APIC timer interrupt vector. */
+#define HRTIMER_VEC 0x30
+
+/* Shortest interval the clock-event device is armed for, since
+   we cannot take the interrupt much sooner anyway. */
+#define MIN_DELTA_NS 1000
+
+/* Longest interval the device is armed for.  A timer further
+   away takes more than one interrupt to reach. */
+#define MAX_DELTA_NS 100000000
+
+static struct rbtree queue;     /* Pending timers by expiry. */
+static uint64_t lapic_hz;       /* Local APIC timer counts/s, or 0. */
+
+/* Statistics. */
+static long long intr_cnt;      /* Clock-event interrupts. */
+static long long fire_cnt;      /* Callbacks run. */
+
+static intr_handler_func hrtimer_interrupt;
+
+static bool
+expires_less (const struct rb_elem *a_, const struct rb_elem *b_,
+		void *aux UNUSED) {
+	const struct hrtimer *a = rb_entry (a_, struct hrtimer, elem);
+	const struct hrtimer *b = rb_entry (b_, struct hrtimer, elem);
+
+	return a->expires < b->expires;
+}
+
+/* Returns the earliest pending timer, or NULL. */
+static struct hrtimer *
+first (void) {
+	struct rb_elem *e = rb_min (&queue);
+	return e != NULL ? rb_entry (e, struct hrtimer, elem) : NULL;
+}
+
+/* Picks the clock-event device: the local APIC timer, calibrated
+   against the PIT, or else the PIT tick.  Must be called after
+   timer_calibrate(), with interrupts on. */
+void
+hrtimer_init (void) {
+	rb_init (&queue, expires_less, NULL);
+
+	lapic_hz = lapic_timer_init (HRTIMER_VEC);
+	if (lapic_hz != 0) {
+		intr_register_apic (HRTIMER_VEC, hrtimer_interrupt, "LAPIC Timer");
+		printf ("hrtimer: local APIC timer, %'"PRIu64" Hz.\n", lapic_hz);
+	} else
+		printf ("hrtimer: no local APIC, using the %d Hz tick.\n",
+				TIMER_FREQ);
+}
+
+/* Returns true if timers fire on time, false if only at ticks. */
+bool
+hrtimer_is_oneshot (void) {
+	return lapic_hz != 0;
+}
+
+/* Initializes timer T to call FUNC with AUX when it expires. */
+void
+hrtimer_setup (struct hrtimer *t, hrtimer_func *func, void *aux) {
+	ASSERT (t != NULL);
+	ASSERT (func != NULL);
+
+	t->expires = 0;
+	t->func = func;
+	t->aux = aux;
+	t->pending = false;
+}
+
+/* Arms the clock-event device for the earliest pending timer. */
+static void
+program (void) {
+	struct hrtimer *t;
+	int64_t delta;
+	uint64_t count;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (lapic_hz == 0)
+		return;
+	t = first ();
+	if (t == NULL) {
+		lapic_timer_oneshot (0);
+		return;
+	}
+
+	delta = t->expires - timer_now_ns ();
+	if (delta < MIN_DELTA_NS)
+		delta = MIN_DELTA_NS;
+	else if (delta > MAX_DELTA_NS)
+		delta = MAX_DELTA_NS;
+	count = (uint64_t) delta * lapic_hz / 1000000000;
+	if (count == 0)
+		count = 1;
+	else if (count > UINT32_MAX)
+		count = UINT32_MAX;
+	lapic_timer_oneshot (count);
+}
+
+/* Arms timer T to fire at EXPIRES, in nanoseconds of
+   timer_now_ns().  A pending T is moved to the new expiry.  T
+   never fires before this function returns, even if EXPIRES is
+   in the past.  May be called from an interrupt handler. */
+void
+hrtimer_start (struct hrtimer *t, int64_t expires) {
+	enum intr_level old_level = intr_disable ();
+
+	if (t->pending)
+		rb_remove (&queue, &t->elem);
+	t->expires = expires;
+	t->pending = true;
+	rb_insert (&queue, &t->elem);
+	if (first () == t)
+		program ();
+	intr_set_level (old_level);
+}
+
+/* Disarms timer T.  Returns true if T was pending, false if it
+   had already fired or was never started.  The device stays
+   armed for T's expiry, when it just finds nothing to do. */
+bool
+hrtimer_cancel (struct hrtimer *t) {
+	enum intr_level old_level = intr_disable ();
+	bool was_pending = t->pending;
+
+	if (was_pending) {
+		rb_remove (&queue, &t->elem);
+		t->pending = false;
+	}
+	intr_set_level (old_level);
+	return was_pending;
+}
+
+/* Runs every timer that has expired. */
+static void
+run_expired (void) {
+	int64_t now = timer_now_ns ();
+	struct hrtimer *t;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while ((t = first ()) != NULL && t->expires <= now) {
+		rb_remove (&queue, &t->elem);
+		t->pending = false;
+		fire_cnt++;
+		t->func (t->aux);
+	}
+}
+
+/* Local APIC timer interrupt handler. */
+static void
+hrtimer_interrupt (struct intr_frame *f UNUSED) {
+	intr_cnt++;
+	run_expired ();
+	program ();
+}
+
+/* Called at every timer tick.  Without a one-shot device, runs
+   the timers that have expired. */
+void
+hrtimer_tick (void) {
+	if (lapic_hz == 0 && !rb_empty (&queue))
+		run_expired ();
+}
+
+/* Returns the earliest expiry that needs a timer tick to run,
+   in nanoseconds, or INT64_MAX if none does: with a one-shot
+   device, no timer needs the tick. */
+int64_t
+hrtimer_next_expiry (void) {
+	struct hrtimer *t;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (lapic_hz != 0 || (t = first ()) == NULL)
+		return INT64_MAX;
+	return t->expires;
+}
+
+/* Wakes up the thread sleeping in hrtimer_sleep(). */
+static void
+wake (void *t) {
+	thread_wake (t);
+}
+
+/* Sleeps for at least NS nanoseconds. */
+void
+hrtimer_sleep (int64_t ns) {
+	struct hrtimer t;
+	enum intr_level old_level;
+
+	ASSERT (!intr_context ());
+	if (ns <= 0)
+		return;
+
+	hrtimer_setup (&t, wake, thread_current ());
+	old_level = intr_disable ();
+	hrtimer_start (&t, timer_now_ns () + ns);
+	thread_block ();
+	intr_set_level (old_level);
+}
+
+/* Prints high-resolution timer statistics. */
+void
+hrtimer_print_stats (void) {
+	if (lapic_hz != 0)
+		printf ("hrtimer: %lld timers fired, %lld LAPIC timer interrupts\n",
+				fire_cnt, intr_cnt);
+	else
+		printf ("hrtimer: %lld timers fired at ticks\n", fire_cnt);
+}
@@ -3,10 +3,13 @@
 #include <inttypes.h>
 #include <round.h>
 #include <stdio.h>
+#include "devices/hrtimer.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/profile.h"
 #include "threads/synch.h"
 #include "threads/thread.h"
+#include "intrinsic.h"
 
 /* See [8254] for hardware details of the 8254 timer chip. */
 
@@ -17,56 +20,155 @@
 #error TIMER_FREQ <= 1000 recommended
 #endif
 
+/* 8254 input frequency, and the counter value for one tick. */
+#define PIT_HZ 1193180
+#define PIT_COUNT ((PIT_HZ + TIMER_FREQ / 2) / TIMER_FREQ)
+
+/* Longest one-shot, in ticks, that fits in the 16-bit counter. */
+#define PIT_MAX_TICKS ((0xffff - PIT_COUNT) / PIT_COUNT + 1)
+
 /* Number of timer ticks since OS booted. */
 static int64_t ticks;
 
-/* Number of loops per timer tick.
-   Initialized by timer_calibrate(). */
-static unsigned loops_per_tick;
+/* PDG -tickless: idle 중에는 주기 인터럽트 대신 다음 타이머 만료
+   시점에 PIT one-shot 인터럽트 한번만 받음 */
+bool timer_tickless;
+
+/* Ticks covered by the armed one-shot, 0 in periodic mode, and
+   the counter value it was loaded with. */
+static int64_t oneshot_ticks;
+static uint32_t oneshot_count;
+
+/* Hierarchical timer wheel.
+
+   Level 0 has one slot per tick for the next WHEEL_SLOTS ticks,
+   and every higher level covers WHEEL_SLOTS times the range of
+   the level below it.  A timer is hashed into a slot by its
+   expiry tick, so adding and cancelling are O(1).  Each tick
+   expires one whole level-0 slot at once; when level 0 wraps
+   around, the matching slot of the next level is cascaded down.
+   Timers beyond the range of the wheel wait in the last level
+   and are cascaded again until they come into range. */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 4
+#define WHEEL_RANGE (1LL << (WHEEL_BITS * WHEEL_LEVELS))
+
+static struct list wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+
+/* Next tick to be processed by the wheel. */
+static int64_t wheel_ticks;
+
+/* Time spent in the timer interrupt handler. */
+static struct timer_intr_stats intr_stats;
+
+/* TSC clocksource.
+
+   timer_calibrate() measures the TSC frequency against the PIT
+   once, after which timer_now_ns() reads the time from the TSC
+   with nanosecond resolution instead of counting ticks.  TSC
+   cycles convert to nanoseconds as CYCLES * tsc_mult >> tsc_shift,
+   with tsc_mult kept below 2**32 so that the products in
+   timer_cycles_to_ns() cannot overflow. */
+#define NS_PER_TICK (1000000000 / TIMER_FREQ)
+
+/* Ticks to measure the TSC over. */
+#define CALIBRATE_TICKS 10
+
+static uint64_t tsc_hz;         /* TSC cycles per second, or 0. */
+static uint64_t tsc_mult;
+static int tsc_shift;
+static uint64_t tsc_base;       /* TSC at tick tsc_base_ticks. */
+static int64_t tsc_base_ticks;
 
 static intr_handler_func timer_interrupt;
-static bool too_many_loops (unsigned loops);
-static void busy_wait (int64_t loops);
 static void real_time_sleep (int64_t num, int32_t denom);
+static void wheel_insert (struct timer_event *);
+static void wheel_cascade (struct list *);
+static void wheel_advance (int64_t now);
+static int64_t wheel_next_expiry (void);
+static void pit_set_periodic (void);
+static void timer_advance (void);
+static void timer_catch_up (int64_t skipped);
+
 /* Sets up the 8254 Programmable Interval Timer (PIT) to
    interrupt PIT_FREQ times per second, and registers the
    corresponding interrupt. */
 void
 timer_init (void) {
-	/* 8254 input frequency divided by TIMER_FREQ, rounded to
-	   nearest. */
-	uint16_t count = (1193180 + TIMER_FREQ / 2) / TIMER_FREQ;
+	int level, slot;
 
-	outb (0x43, 0x34);    /* CW: counter 0, LSB then MSB, mode 2, binary. */
-	outb (0x40, count & 0xff);
-	outb (0x40, count >> 8);
+	for (level = 0; level < WHEEL_LEVELS; level++)
+		for (slot = 0; slot < WHEEL_SLOTS; slot++)
+			list_init (&wheel[level][slot]);
 
+	pit_set_periodic ();
 	intr_register_ext (0x20, timer_interrupt, "8254 Timer");
 }
 
-/* Calibrates loops_per_tick, used to implement brief delays. */
+/* Waits for the next timer tick, then returns the TSC. */
+static uint64_t
+tsc_at_tick (void) {
+	int64_t start = ticks;
+
+	while (ticks == start)
+		barrier ();
+	return rdtsc ();
+}
+
+/* Calibrates the TSC clocksource against the PIT. */
 void
 timer_calibrate (void) {
-	unsigned high_bit, test_bit;
+	uint64_t start, cycles;
 
 	ASSERT (intr_get_level () == INTR_ON);
 	printf ("Calibrating timer...  ");
 
-	/* Approximate loops_per_tick as the largest power-of-two
-	   still less than one timer tick. */
-	loops_per_tick = 1u << 10;
-	while (!too_many_loops (loops_per_tick << 1)) {
-		loops_per_tick <<= 1;
-		ASSERT (loops_per_tick != 0);
+	/* Count TSC cycles between two tick edges, CALIBRATE_TICKS
+	   apart, so that the interrupt latency at either edge is a
+	   small fraction of the total. */
+	start = tsc_at_tick ();
+	intr_disable ();
+	tsc_base_ticks = ticks;
+	intr_enable ();
+	while (timer_ticks () < tsc_base_ticks + CALIBRATE_TICKS - 1)
+		barrier ();
+	cycles = tsc_at_tick () - start;
+
+	intr_disable ();
+	tsc_hz = cycles * TIMER_FREQ / CALIBRATE_TICKS;
+	for (tsc_shift = 32; ; tsc_shift--) {
+		tsc_mult = (1000000000ULL << tsc_shift) / tsc_hz;
+		if (tsc_mult < (1ULL << 32))
+			break;
 	}
+	tsc_base = start;
+	intr_enable ();
+
+	printf ("%'"PRIu64" TSC cycles/s.\n", tsc_hz);
+}
+
+/* Converts CYCLES of the TSC into nanoseconds.  Returns 0 before
+   timer_calibrate(). */
+uint64_t
+timer_cycles_to_ns (uint64_t cycles) {
+	uint64_t low = cycles & ((1ULL << tsc_shift) - 1);
 
-	/* Refine the next 8 bits of loops_per_tick. */
-	high_bit = loops_per_tick;
-	for (test_bit = high_bit >> 1; test_bit != high_bit >> 10; test_bit >>= 1)
-		if (!too_many_loops (high_bit | test_bit))
-			loops_per_tick |= test_bit;
+	if (tsc_hz == 0)
+		return 0;
+	return (cycles >> tsc_shift) * tsc_mult + ((low * tsc_mult) >> tsc_shift);
+}
 
-	printf ("%'"PRIu64" loops/s.\n", (uint64_t) loops_per_tick * TIMER_FREQ);
+/* Returns the number of nanoseconds since the OS booted, with
+   the resolution of the TSC, or only of timer ticks before
+   timer_calibrate(). */
+int64_t
+timer_now_ns (void) {
+	if (tsc_hz == 0)
+		return timer_ticks () * NS_PER_TICK;
+	return tsc_base_ticks * NS_PER_TICK
+		+ (int64_t) timer_cycles_to_ns (rdtsc () - tsc_base);
 }
 
 /* Returns the number of timer ticks since the OS booted. */
@@ -128,60 +230,293 @@ timer_print_stats (void) {
 	printf ("Timer: %"PRId64" ticks\n", timer_ticks ());
 }
 
+/* Programs the PIT to interrupt TIMER_FREQ times per second. */
+static void
+pit_set_periodic (void) {
+	/* 8254 input frequency divided by TIMER_FREQ, rounded to
+	   nearest. */
+	uint16_t count = PIT_COUNT;
+
+	outb (0x43, 0x34);    /* CW: counter 0, LSB then MSB, mode 2, binary. */
+	outb (0x40, count & 0xff);
+	outb (0x40, count >> 8);
+}
+
+/* Called by the idle thread, with interrupts off, right before
+   it halts.  In tickless mode, replaces the periodic tick by a
+   single interrupt at the next timer expiry (bounded by the
+   range of the counter). */
+void
+timer_idle_enter (void) {
+	uint16_t remaining;
+	int64_t next, hr_next, delta;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	if (!timer_tickless || oneshot_ticks != 0)
+		return;
+
+	/* Without a one-shot device, high-resolution timers also
+	   wait for a tick. */
+	next = wheel_next_expiry ();
+	hr_next = hrtimer_next_expiry ();
+	if (hr_next != INT64_MAX && DIV_ROUND_UP (hr_next, NS_PER_TICK) < next)
+		next = DIV_ROUND_UP (hr_next, NS_PER_TICK);
+	delta = next - ticks;
+	if (delta > PIT_MAX_TICKS)
+		delta = PIT_MAX_TICKS;
+	if (delta < 2)
+		return;
+
+	/* Keep the phase of the current tick: the one-shot ends where
+	   the (DELTA)th periodic interrupt would have come. */
+	outb (0x43, 0x00);    /* Latch counter 0. */
+	remaining = inb (0x40);
+	remaining |= inb (0x40) << 8;
+
+	oneshot_ticks = delta;
+	oneshot_count = remaining + (delta - 1) * PIT_COUNT;
+	outb (0x43, 0x30);    /* CW: counter 0, LSB then MSB, mode 0, binary. */
+	outb (0x40, oneshot_count & 0xff);
+	outb (0x40, oneshot_count >> 8);
+}
+
+/* Called by the idle thread, with interrupts off, after it was
+   woken, and before it yields to a thread that an interrupt
+   woke.  If the one-shot is still armed, some other interrupt
+   woke us up: accounts the ticks that went by and goes back to
+   periodic mode. */
+void
+timer_idle_exit (void) {
+	uint8_t status;
+	uint16_t remaining;
+	int64_t elapsed;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	if (oneshot_ticks == 0)
+		return;
+
+	outb (0x43, 0xc2);    /* Read-back: latch status and count of counter 0. */
+	status = inb (0x40);
+	remaining = inb (0x40);
+	remaining |= inb (0x40) << 8;
+
+	/* If OUT is already high, the one-shot interrupt is pending
+	   and will account the last tick itself.  Otherwise reloading
+	   the counter raises OUT and delivers one more interrupt,
+	   which accounts the partially elapsed tick. */
+	if (status & 0x80)
+		elapsed = oneshot_ticks - 1;
+	else
+		elapsed = (oneshot_count - remaining) / PIT_COUNT;
+
+	oneshot_ticks = 0;
+	pit_set_periodic ();
+	timer_catch_up (elapsed);
+}
+
 /* Timer interrupt handler. */
 static void
-timer_interrupt (struct intr_frame *args UNUSED) {
+timer_interrupt (struct intr_frame *args) {
+	uint64_t start = rdtsc ();
+	uint64_t cycles;
+
+	if (profile_enabled)
+		profile_tick (args);
+
+	/* PDG one-shot 만료: 건너뛴 틱을 먼저 따라잡고 주기 모드로 복귀 */
+	if (oneshot_ticks != 0) {
+		int64_t skipped = oneshot_ticks - 1;
+
+		oneshot_ticks = 0;
+		pit_set_periodic ();
+		timer_catch_up (skipped);
+	}
+	timer_advance ();
+
+	cycles = rdtsc () - start;
+	intr_stats.count++;
+	intr_stats.total_cycles += cycles;
+	if (intr_stats.max_cycles < cycles)
+		intr_stats.max_cycles = cycles;
+	if (ticks % TIMER_FREQ == 0) {
+		intr_stats.recalc_count++;
+		intr_stats.recalc_total_cycles += cycles;
+		if (intr_stats.recalc_max_cycles < cycles)
+			intr_stats.recalc_max_cycles = cycles;
+	}
+}
+
+/* Copies the timer interrupt statistics into STATS. */
+void
+timer_get_intr_stats (struct timer_intr_stats *stats) {
+	enum intr_level old_level = intr_disable ();
+	*stats = intr_stats;
+	intr_set_level (old_level);
+}
+
+/* Resets the timer interrupt statistics. */
+void
+timer_reset_intr_stats (void) {
+	enum intr_level old_level = intr_disable ();
+	intr_stats = (struct timer_intr_stats) { .count = 0 };
+	intr_set_level (old_level);
+}
+
+/* Accounts SKIPPED ticks during which the CPU was idle, as if
+   the timer interrupt had fired for each of them. */
+static void
+timer_catch_up (int64_t skipped) {
+	while (skipped-- > 0)
+		timer_advance ();
+}
+
+/* Work done once per timer tick. */
+static void
+timer_advance (void) {
 	ticks++;
+	/* PDG MLFQ 등 스케줄러 틱 작업은 thread_tick에서 클래스별로 처리 */
 	thread_tick ();
 
-	/* PDG MLFQ 틱마다 동작 구현 */
-	if(thread_mlfqs){
-		mlfqs_increment();
-		/* 해당 부분 100틱 4틱 우선 순위 체크 필요 */
-		if(ticks % TIMER_FREQ == 0){	
-			mlfqs_recalc();
-		}
-		else if(ticks % 4 == 0){
-			mlfqs_priority(thread_current());
-		}
-	}
+	/* PDG 만료된 타이머 슬롯 일괄 처리 */
+	wheel_advance (ticks);
+	hrtimer_tick ();
+}
+
+/* Initializes timer EV to call FUNC with AUX when it expires. */
+void
+timer_event_init (struct timer_event *ev, timer_func *func, void *aux) {
+	ASSERT (ev != NULL);
+	ASSERT (func != NULL);
+
+	ev->expires = 0;
+	ev->func = func;
+	ev->aux = aux;
+	ev->pending = false;
+}
+
+/* Arms timer EV to fire at timer tick EXPIRES.  A pending EV is
+   moved to the new expiry.  An expiry in the past fires on the
+   next tick.  May be called from an interrupt handler. */
+void
+timer_add (struct timer_event *ev, int64_t expires) {
+	enum intr_level old_level = intr_disable ();
 
-	/*PDG start*/
-	while(get_globalticks() <= ticks){
-		thread_wakeup();
+	if (ev->pending)
+		list_remove (&ev->elem);
+	ev->expires = expires;
+	ev->pending = true;
+	wheel_insert (ev);
+	intr_set_level (old_level);
+}
+
+/* Disarms timer EV.  Returns true if EV was pending, false if
+   it had already fired or was never added. */
+bool
+timer_cancel (struct timer_event *ev) {
+	enum intr_level old_level = intr_disable ();
+	bool was_pending = ev->pending;
+
+	if (was_pending) {
+		list_remove (&ev->elem);
+		ev->pending = false;
 	}
-	/*PDG end*/
+	intr_set_level (old_level);
+	return was_pending;
 }
 
-/* Returns true if LOOPS iterations waits for more than one timer
-   tick, otherwise false. */
-static bool
-too_many_loops (unsigned loops) {
-	/* Wait for a timer tick. */
-	int64_t start = ticks;
-	while (ticks == start)
-		barrier ();
+/* Returns the earliest tick at which the wheel has work to do:
+   a level-0 timer expiring, or a higher level cascading down.
+   Returns INT64_MAX if no timer is pending. */
+static int64_t
+wheel_next_expiry (void) {
+	int64_t next = INT64_MAX;
+	int level, slot;
 
-	/* Run LOOPS loops. */
-	start = ticks;
-	busy_wait (loops);
+	for (slot = 0; slot < WHEEL_SLOTS; slot++)
+		if (!list_empty (&wheel[0][(wheel_ticks + slot) & WHEEL_MASK])) {
+			next = wheel_ticks + slot;
+			break;
+		}
 
-	/* If the tick count changed, we iterated too long. */
-	barrier ();
-	return start != ticks;
+	for (level = 1; level < WHEEL_LEVELS; level++)
+		for (slot = 0; slot < WHEEL_SLOTS; slot++)
+			if (!list_empty (&wheel[level][slot])) {
+				int64_t cascade = ROUND_UP (wheel_ticks, WHEEL_SLOTS);
+				return cascade < next ? cascade : next;
+			}
+	return next;
 }
 
-/* Iterates through a simple loop LOOPS times, for implementing
-   brief delays.
+/* Hashes EV into the wheel slot for its expiry tick. */
+static void
+wheel_insert (struct timer_event *ev) {
+	int64_t expires = ev->expires;
+	int64_t delta = expires - wheel_ticks;
+	int level;
 
-   Marked NO_INLINE because code alignment can significantly
-   affect timings, so that if this function was inlined
-   differently in different places the results would be difficult
-   to predict. */
-static void NO_INLINE
-busy_wait (int64_t loops) {
-	while (loops-- > 0)
-		barrier ();
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (delta < 0)
+		expires = wheel_ticks;
+	else if (delta >= WHEEL_RANGE)
+		expires = wheel_ticks + WHEEL_RANGE - 1;
+	delta = expires - wheel_ticks;
+
+	for (level = 0; level < WHEEL_LEVELS - 1; level++)
+		if (delta < (1LL << (WHEEL_BITS * (level + 1))))
+			break;
+	list_push_back (&wheel[level][(expires >> (WHEEL_BITS * level)) & WHEEL_MASK],
+			&ev->elem);
+}
+
+/* Re-inserts every timer in SLOT relative to the current tick,
+   which moves each of them down at least one level. */
+static void
+wheel_cascade (struct list *slot) {
+	struct list timers;
+
+	if (list_empty (slot))
+		return;
+	list_init (&timers);
+	list_splice (list_end (&timers), list_begin (slot), list_end (slot));
+	while (!list_empty (&timers))
+		wheel_insert (list_entry (list_pop_front (&timers),
+					struct timer_event, elem));
+}
+
+/* Runs every timer that expires at or before tick NOW. */
+static void
+wheel_advance (int64_t now) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (wheel_ticks <= now) {
+		int index = wheel_ticks & WHEEL_MASK;
+		struct list *slot = &wheel[0][index];
+		struct list expired;
+		int level;
+
+		if (index == 0)
+			for (level = 1; level < WHEEL_LEVELS; level++) {
+				int upper = (wheel_ticks >> (WHEEL_BITS * level)) & WHEEL_MASK;
+				wheel_cascade (&wheel[level][upper]);
+				if (upper != 0)
+					break;
+			}
+
+		/* Detach the whole slot first, so callbacks may add or
+		   cancel timers freely. */
+		list_init (&expired);
+		if (!list_empty (slot))
+			list_splice (list_end (&expired), list_begin (slot), list_end (slot));
+		wheel_ticks++;
+
+		while (!list_empty (&expired)) {
+			struct timer_event *ev = list_entry (list_pop_front (&expired),
+					struct timer_event, elem);
+			ev->pending = false;
+			ev->func (ev->aux);
+		}
+	}
 }
 
 /* Sleep for approximately NUM/DENOM seconds. */
@@ -202,10 +537,14 @@ real_time_sleep (int64_t num, int32_t denom) {
 		   processes. */
 		timer_sleep (ticks);
 	} else {
-		/* Otherwise, use a busy-wait loop for more accurate
-		   sub-tick timing.  We scale the numerator and denominator
-		   down by 1000 to avoid the possibility of overflow. */
-		ASSERT (denom % 1000 == 0);
-		busy_wait (loops_per_tick * num / 1000 * TIMER_FREQ / (denom / 1000));
+		/* Otherwise, busy-wait on the TSC for more accurate
+		   sub-tick timing. */
+		int64_t end;
+
+		ASSERT (tsc_hz != 0);
+		ASSERT (1000000000 % denom == 0);
+		end = timer_now_ns () + num * (1000000000 / denom);
+		while (timer_now_ns () < end)
+			barrier ();
 	}
 }
@@ -0,0 +1,33 @@
+#ifndef DEVICES_HRTIMER_H
+#define DEVICES_HRTIMER_H
+
+#include <rbtree.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* High-resolution timer callback.  Runs in an interrupt, with
+   interrupts off, so it must not sleep. */
+typedef void hrtimer_func (void *aux);
+
+/* A high-resolution timer.  Owned by the caller; it must stay
+   valid until it fires or is cancelled. */
+struct hrtimer {
+	int64_t expires;            /* timer_now_ns() to fire at. */
+	hrtimer_func *func;         /* Callback. */
+	void *aux;                  /* Argument for FUNC. */
+	bool pending;               /* Currently queued? */
+	struct rb_elem elem;        /* Element in queue by expiry. */
+};
+
+void hrtimer_init (void);
+void hrtimer_setup (struct hrtimer *, hrtimer_func *, void *aux);
+void hrtimer_start (struct hrtimer *, int64_t expires);
+bool hrtimer_cancel (struct hrtimer *);
+void hrtimer_sleep (int64_t ns);
+bool hrtimer_is_oneshot (void);
+
+void hrtimer_tick (void);
+int64_t hrtimer_next_expiry (void);
+void hrtimer_print_stats (void);
+
+#endif /* devices/hrtimer.h */
@@ -1,17 +1,26 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Number of timer interrupts per second. */
 #define TIMER_FREQ 100
 
+/* Controlled by kernel command-line option "-tickless". */
+extern bool timer_tickless;
+
 void timer_init (void);
 void timer_calibrate (void);
+void timer_idle_enter (void);
+void timer_idle_exit (void);
 
 int64_t timer_ticks (void);
 int64_t timer_elapsed (int64_t);
+int64_t timer_now_ns (void);
+uint64_t timer_cycles_to_ns (uint64_t cycles);
 
 void timer_sleep (int64_t ticks);
 void timer_msleep (int64_t milliseconds);
@@ -20,4 +29,37 @@ void timer_nsleep (int64_t nanoseconds);
 
 void timer_print_stats (void);
 
+/* Cost of the timer interrupt handler, in TSC cycles.  The
+   recalc_* fields only count the once-per-second ticks, which
+   run the scheduler's periodic recomputation (e.g. MLFQS). */
+struct timer_intr_stats {
+	int64_t count;
+	uint64_t total_cycles;
+	uint64_t max_cycles;
+	int64_t recalc_count;
+	uint64_t recalc_total_cycles;
+	uint64_t recalc_max_cycles;
+};
+
+void timer_get_intr_stats (struct timer_intr_stats *);
+void timer_reset_intr_stats (void);
+
+/* Kernel timer callback.  Runs in the timer interrupt, with
+   interrupts off, so it must not sleep. */
+typedef void timer_func (void *aux);
+
+/* A kernel timer.  Owned by the caller; it must stay valid
+   until it fires or is cancelled. */
+struct timer_event {
+	int64_t expires;            /* Tick at which FUNC is called. */
+	timer_func *func;           /* Callback. */
+	void *aux;                  /* Argument for FUNC. */
+	bool pending;               /* Currently queued on the wheel? */
+	struct list_elem elem;      /* Timer wheel slot element. */
+};
+
+void timer_event_init (struct timer_event *, timer_func *, void *aux);
+void timer_add (struct timer_event *, int64_t expires);
+bool timer_cancel (struct timer_event *);
+
 #endif /* devices/timer.h */
@@ -0,0 +1,67 @@
+#ifndef __LIB_KERNEL_RBTREE_H
+#define __LIB_KERNEL_RBTREE_H
+
+/* Red-black tree.
+ *
+ * A balanced binary search tree: insertion and removal take
+ * O(log n) time, and the smallest element is cached so that
+ * finding it takes O(1).
+ *
+ * Like the hash table, this tree does not allocate memory.
+ * Each structure that can be in a tree embeds a struct rb_elem,
+ * and rb_entry() converts a struct rb_elem back into the
+ * structure that contains it.  See lib/kernel/list.h for a
+ * detailed explanation of the technique.
+ *
+ * Elements that compare equal are kept in insertion order, so a
+ * tree can serve as a priority queue that is FIFO among equal
+ * keys. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Red-black tree element. */
+struct rb_elem {
+	struct rb_elem *parent;     /* Parent, or null for the root. */
+	struct rb_elem *left;       /* Left child. */
+	struct rb_elem *right;      /* Right child. */
+	bool red;                   /* Node color. */
+};
+
+/* Converts pointer to tree element RB_ELEM into a pointer to
+ * the structure that RB_ELEM is embedded inside.  Supply the
+ * name of the outer structure STRUCT and the member name MEMBER
+ * of the tree element. */
+#define rb_entry(RB_ELEM, STRUCT, MEMBER)                       \
+	((STRUCT *) ((uint8_t *) &(RB_ELEM)->parent             \
+		- offsetof (STRUCT, MEMBER.parent)))
+
+/* Compares the value of two tree elements A and B, given
+ * auxiliary data AUX.  Returns true if A is less than B, or
+ * false if A is greater than or equal to B. */
+typedef bool rb_less_func (const struct rb_elem *a,
+		const struct rb_elem *b,
+		void *aux);
+
+/* Red-black tree. */
+struct rbtree {
+	struct rb_elem *root;       /* Root, or null if empty. */
+	struct rb_elem *min;        /* Smallest element, or null if empty. */
+	size_t elem_cnt;            /* Number of elements in tree. */
+	rb_less_func *less;         /* Comparison function. */
+	void *aux;                  /* Auxiliary data for `less'. */
+};
+
+void rb_init (struct rbtree *, rb_less_func *, void *aux);
+
+void rb_insert (struct rbtree *, struct rb_elem *);
+void rb_remove (struct rbtree *, struct rb_elem *);
+
+struct rb_elem *rb_min (const struct rbtree *);
+struct rb_elem *rb_next (struct rb_elem *);
+
+size_t rb_size (const struct rbtree *);
+bool rb_empty (const struct rbtree *);
+
+#endif /* lib/kernel/rbtree.h */
@@ -0,0 +1,21 @@
+#ifndef __LIB_LOCKSTAT_H
+#define __LIB_LOCKSTAT_H
+
+#include <stdint.h>
+
+/* Contention statistics for the locks initialized at one site,
+   shared by the kernel and user programs.  Filled in by the
+   lockstat() system call.  Times are in TSC cycles. */
+struct lockstat {
+	char name[32];              /* Lock passed to lock_init(). */
+	char file[24];              /* Source file of the lock_init() call. */
+	int line;                   /* Line of the lock_init() call. */
+	uint64_t acquired;          /* Acquisitions. */
+	uint64_t contended;         /* Acquisitions that had to wait. */
+	uint64_t wait_total;        /* Time spent waiting, in total. */
+	uint64_t wait_max;          /* Longest wait. */
+	uint64_t hold_total;        /* Time held, in total. */
+	uint64_t hold_max;          /* Longest hold. */
+};
+
+#endif /* lib/lockstat.h */
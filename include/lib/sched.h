@@ -0,0 +1,15 @@
+#ifndef __LIB_SCHED_H
+#define __LIB_SCHED_H
+
+/* Scheduling policies, shared by the kernel and user programs.
+   Passed to the sched_setscheduler() system call. */
+enum sched_policy {
+	SCHED_NORMAL,               /* Time-shared: priority or MLFQS. */
+	SCHED_FIFO,                 /* Real-time, run until block or yield. */
+	SCHED_RR,                   /* Real-time, round-robin time slices. */
+	SCHED_IDLE,                 /* Runs only when nothing else is ready. */
+	SCHED_DEADLINE,             /* Earliest deadline first, with reserved
+	                               bandwidth.  See sched_setdeadline(). */
+};
+
+#endif /* lib/sched.h */
@@ -36,6 +36,16 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* Scheduling. */
+	SYS_SCHED_SETSCHEDULER,     /* Change the scheduling class. */
+	SYS_SCHED_SETDEADLINE,      /* Reserve CPU bandwidth (EDF). */
+
+	/* Statistics. */
+	SYS_LOCKSTAT,               /* Read lock contention statistics. */
+
+	/* Timers. */
+	SYS_NANOSLEEP,              /* Sleep for some nanoseconds. */
 };
 
 #endif /* lib/syscall-nr.h */
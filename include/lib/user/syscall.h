@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <lockstat.h>
+#include <sched.h>
 #include "threads/synch.h"
 
 /* Process identifier. */
@@ -51,6 +54,12 @@ bool isdir (int fd);
 int inumber (int fd);
 int symlink (const char* target, const char* linkpath);
 
+/* Scheduling. */
+int sched_setscheduler (int policy, int priority);
+int sched_setdeadline (int64_t runtime, int64_t deadline, int64_t period);
+int lockstat (struct lockstat *, int cnt);
+int nanosleep (int64_t ns);
+
 static inline void* get_phys_addr (void *user_addr) {
 	void* pa;
 	asm volatile ("movq %0, %%rax" ::"r"(user_addr));
@@ -67,8 +67,10 @@ typedef void intr_handler_func (struct intr_frame *);
 
 void intr_init (void);
 void intr_register_ext (uint8_t vec, intr_handler_func *, const char *name);
+void intr_register_apic (uint8_t vec, intr_handler_func *, const char *name);
 void intr_register_int (uint8_t vec, int dpl, enum intr_level,
                         intr_handler_func *, const char *name);
+void intr_set_ist (uint8_t vec, int ist);
 bool intr_context (void);
 void intr_yield_on_return (void);
 
@@ -0,0 +1,33 @@
+#ifndef THREADS_IRQSOFF_H
+#define THREADS_IRQSOFF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct intr_frame;
+
+/* Most critical sections the irqsoff tracer can keep. */
+#define IRQSOFF_MAX 32
+
+/* Return addresses kept from where interrupts were turned off. */
+#define IRQSOFF_DEPTH 4
+
+/* A section of code that ran with interrupts off. */
+struct irqsoff_section {
+	uint64_t cycles;                /* Length, in TSC cycles. */
+	const char *intr;               /* Interrupt that turned them off,
+	                                   or NULL for intr_disable(). */
+	void *off[IRQSOFF_DEPTH];       /* Backtrace where turned off. */
+	void *on;                       /* Where turned back on. */
+};
+
+extern bool irqsoff_enabled;
+
+void irqsoff_init (int cnt);
+void irqsoff_begin (void **frame);
+void irqsoff_begin_intr (const struct intr_frame *);
+void irqsoff_end (void *caller);
+uint64_t irqsoff_worst (void);
+void irqsoff_print_stats (void);
+
+#endif /* threads/irqsoff.h */
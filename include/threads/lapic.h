@@ -0,0 +1,31 @@
+#ifndef THREADS_LAPIC_H
+#define THREADS_LAPIC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Local APIC registers, as byte offsets. */
+#define LAPIC_ID 0x020          /* ID. */
+#define LAPIC_VER 0x030         /* Version. */
+#define LAPIC_TPR 0x080         /* Task priority. */
+#define LAPIC_EOI 0x0b0         /* End of interrupt. */
+#define LAPIC_SVR 0x0f0         /* Spurious interrupt vector. */
+#define LAPIC_ESR 0x280         /* Error status. */
+#define LAPIC_LVT_TIMER 0x320   /* Timer local vector table entry. */
+#define LAPIC_TIMER_ICR 0x380   /* Timer initial count. */
+#define LAPIC_TIMER_CCR 0x390   /* Timer current count. */
+#define LAPIC_TIMER_DCR 0x3e0   /* Timer divide configuration. */
+
+/* Controlled by kernel command-line option "-nolapic". */
+extern bool lapic_disabled;
+
+bool lapic_init (void);
+bool lapic_present (void);
+uint32_t lapic_read (int reg);
+void lapic_write (int reg, uint32_t value);
+void lapic_eoi (void);
+
+uint64_t lapic_timer_init (uint8_t vec);
+void lapic_timer_oneshot (uint32_t count);
+
+#endif /* threads/lapic.h */
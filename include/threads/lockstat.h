@@ -0,0 +1,31 @@
+#ifndef THREADS_LOCKSTAT_H
+#define THREADS_LOCKSTAT_H
+
+#include <lockstat.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct lock;
+
+/* Statistics shared by all the locks initialized by one
+   lock_init() call.  With LOCKSTAT defined, lock_init() is a
+   macro that gives each call site its own static lock_class. */
+struct lock_class {
+	const char *name;           /* Argument of lock_init(), as text. */
+	const char *file;           /* Site of the lock_init() call. */
+	int line;
+	struct lock_class *next;    /* Next in list of all classes. */
+	bool registered;            /* In list of all classes? */
+	struct lockstat stat;       /* Statistics so far. */
+};
+
+#define LOCK_CLASS_INITIALIZER(NAME) \
+	{ .name = (NAME), .file = __FILE__, .line = __LINE__ }
+
+void lockstat_register (struct lock_class *);
+void lockstat_acquired (struct lock *, uint64_t start, bool contended);
+void lockstat_released (struct lock *);
+int lockstat_copy (struct lockstat *, int cnt);
+void lockstat_print_stats (void);
+
+#endif /* threads/lockstat.h */
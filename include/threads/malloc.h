@@ -2,6 +2,7 @@
 #define THREADS_MALLOC_H
 
 #include <debug.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 void malloc_init (void);
@@ -9,5 +10,6 @@ void *malloc (size_t) __attribute__ ((malloc));
 void *calloc (size_t, size_t) __attribute__ ((malloc));
 void *realloc (void *, size_t);
 void free (void *);
+bool malloc_reclaim (void);
 
 #endif /* threads/malloc.h */
@@ -1,6 +1,7 @@
 #ifndef THREADS_PALLOC_H
 #define THREADS_PALLOC_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -11,13 +12,30 @@ enum palloc_flags {
 	PAL_USER = 004              /* User page. */
 };
 
+/* Page counts of a pool. */
+struct palloc_stats {
+	size_t page_cnt;            /* Pages in the pool. */
+	size_t free_cnt;            /* Pages free. */
+	size_t mag_cnt;             /* Of those, cached in a magazine. */
+	size_t zero_cnt;            /* Pages allocated and pre-zeroed. */
+	unsigned long long zero_hits;   /* 1-page PAL_ZERO requests pre-zeroed. */
+	unsigned long long zero_misses; /* 1-page PAL_ZERO requests zeroed inline. */
+};
+
 /* Maximum number of pages to put in user pool. */
 extern size_t user_page_limit;
 
+/* Check allocations against a bitmap of pages in use? */
+extern bool palloc_check;
+
 uint64_t palloc_init (void);
 void *palloc_get_page (enum palloc_flags);
 void *palloc_get_multiple (enum palloc_flags, size_t page_cnt);
 void palloc_free_page (void *);
 void palloc_free_multiple (void *, size_t page_cnt);
+bool palloc_claim (void *, size_t page_cnt);
+void palloc_get_stats (enum palloc_flags, struct palloc_stats *);
+bool palloc_zero_idle (void);
+void palloc_print_stats (void);
 
 #endif /* threads/palloc.h */
@@ -0,0 +1,25 @@
+#ifndef THREADS_PROFILE_H
+#define THREADS_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "threads/thread.h"
+
+struct intr_frame;
+
+/* Deepest stack the profiler records, including the
+   interrupted instruction. */
+#define PROFILE_DEPTH 8
+
+/* Number of distinct (thread, stack) pairs the profiler can
+   count.  Must be a power of 2. */
+#define PROFILE_SLOTS 512
+
+extern bool profile_enabled;
+
+void profile_init (int interval);
+void profile_tick (const struct intr_frame *);
+uint64_t profile_samples (tid_t);
+void profile_print_stats (void);
+
+#endif /* threads/profile.h */
@@ -0,0 +1,96 @@
+#ifndef THREADS_SCHED_H
+#define THREADS_SCHED_H
+
+#include <list.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "threads/thread.h"
+
+/* # of timer ticks to give each thread in a round-robin class. */
+#define TIME_SLICE 4
+
+/* Class ranks.  A ready thread of a lower-ranked class always
+   runs before any thread of a higher-ranked class. */
+#define SCHED_RANK_DL 0
+#define SCHED_RANK_RT 1
+#define SCHED_RANK_NORMAL 2
+#define SCHED_RANK_IDLE 3
+
+/* A scheduling class.
+
+   Each thread belongs to exactly one class, which owns the
+   thread while it is THREAD_READY.  thread.c asks the classes
+   in rank order for the next thread to run.  Every operation is
+   called with interrupts off. */
+struct sched_class {
+	const char *name;
+	int rank;                   /* See SCHED_RANK_*. */
+	bool priority_donation;     /* Whether locks donate priority. */
+
+	/* Initializes the class's run queue. */
+	void (*init) (void);
+
+	/* Adds ready thread T to the run queue. */
+	void (*enqueue) (struct thread *t);
+
+	/* Removes ready thread T from the run queue. */
+	void (*dequeue) (struct thread *t);
+
+	/* Removes and returns the thread to run next, or a null
+	   pointer if the run queue is empty. */
+	struct thread *(*pick_next) (void);
+
+	/* Called at each timer tick while CURR, a thread of this
+	   class, is running.  RAN is the number of ticks since CURR
+	   was scheduled.  Returns true if CURR should yield. */
+	bool (*tick) (struct thread *curr, unsigned ran);
+
+	/* Puts CURR, which is yielding the CPU, back on the run
+	   queue. */
+	void (*yield) (struct thread *curr);
+
+	/* Returns true if a thread on this class's run queue should
+	   preempt CURR.  CURR belongs to this class or to a class of
+	   higher rank. */
+	bool (*preempt_check) (struct thread *curr);
+
+	/* If nonnull, called at every timer tick no matter which
+	   class is running, for class-wide bookkeeping. */
+	void (*clock) (void);
+
+	/* If nonnull, called when T leaves this class, either for
+	   another class or because T is exiting. */
+	void (*detach) (struct thread *t);
+
+	/* If nonnull, called when T, which is not on any run queue,
+	   joins this class from another class. */
+	void (*attach) (struct thread *t);
+};
+
+extern const struct sched_class dl_sched_class;
+extern const struct sched_class rt_sched_class;
+extern const struct sched_class fair_sched_class;
+extern const struct sched_class idle_sched_class;
+
+/* Deadline class admission control. */
+extern int sched_dl_bw_limit;
+bool sched_dl_admit (struct thread *, int64_t runtime, int64_t deadline,
+		int64_t period);
+
+/* Per-priority FIFO run queues with a bitmap of the non-empty
+   ones, so that push, pop and remove are all O(1). */
+struct prio_rq {
+	struct list queue[PRI_MAX + 1]; /* queue[p] holds priority p. */
+	uint64_t bitmap;            /* Bit p set iff queue[p] nonempty. */
+	size_t cnt;                 /* Number of queued threads. */
+};
+
+void prio_rq_init (struct prio_rq *);
+void prio_rq_push (struct prio_rq *, struct thread *);
+struct thread *prio_rq_pop (struct prio_rq *);
+void prio_rq_remove (struct prio_rq *, struct thread *);
+int prio_rq_max (const struct prio_rq *);
+
+#endif /* threads/sched.h */
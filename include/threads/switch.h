@@ -0,0 +1,34 @@
+#ifndef THREADS_SWITCH_H
+#define THREADS_SWITCH_H
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+
+/* switch_threads()'s stack frame: the callee-saved registers,
+   pushed in this order from the bottom up, then the return
+   address. */
+struct switch_threads_frame {
+	uint64_t r15;
+	uint64_t r14;
+	uint64_t r13;
+	uint64_t r12;
+	uint64_t rbp;
+	uint64_t rbx;
+	void (*rip) (void);
+};
+
+struct thread;
+
+/* Switches from CUR, which must be the running thread, to NEXT,
+   which must also be suspended in switch_threads() or be a new
+   thread whose stack holds a frame that returns to
+   switch_entry().  Returns CUR in NEXT's context. */
+struct thread *switch_threads (struct thread *cur, struct thread *next);
+
+/* Where a new thread's first switch_threads() returns to.  It
+   enters the thread through its `tf' with do_iret(), which it
+   expects in rbx. */
+void switch_entry (void);
+#endif
+
+#endif /* threads/switch.h */
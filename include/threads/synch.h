@@ -3,15 +3,44 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include "threads/interrupt.h"
+#ifdef LOCKSTAT
+#include "threads/lockstat.h"
+#endif
+
+struct thread;
+
+/* A wait queue of blocked threads, ordered so that the first is
+   the one of the earliest scheduling class and then the highest
+   priority, and among equals the one that has waited longest.
+   It is a pairing heap whose nodes are embedded in struct thread,
+   so finding the first thread takes O(1) time and removing any
+   thread O(log n) amortized. */
+struct waitq_elem {
+	struct waitq_elem *child;   /* First child. */
+	struct waitq_elem *next;    /* Next sibling. */
+	struct waitq_elem *prev;    /* Previous sibling, or parent. */
+	uint64_t seq;               /* Arrival order. */
+};
+
+struct waitq {
+	struct waitq_elem *root;    /* First thread's node, or NULL. */
+};
+
+void waitq_init (struct waitq *);
+bool waitq_empty (const struct waitq *);
+void waitq_requeue (struct thread *);
 
 /* A counting semaphore. */
 struct semaphore {
 	unsigned value;             /* Current value. */
-	struct list waiters;        /* List of waiting threads. */
+	struct waitq waiters;       /* Waiting threads. */
 };
 
 void sema_init (struct semaphore *, unsigned value);
 void sema_down (struct semaphore *);
+bool sema_down_timeout (struct semaphore *, int64_t ticks);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
@@ -20,24 +49,84 @@ void sema_self_test (void);
 struct lock {
 	struct thread *holder;      /* Thread holding lock (for debugging). */
 	struct semaphore semaphore; /* Binary semaphore controlling access. */
+	struct list_elem elem;      /* Element in holder's held_locks. */
+#ifdef LOCKSTAT
+	struct lock_class *class;   /* Statistics, or NULL if untracked. */
+	uint64_t hold_start;        /* TSC when last acquired. */
+#endif
 };
 
 void lock_init (struct lock *);
 void lock_acquire (struct lock *);
+bool lock_acquire_timeout (struct lock *, int64_t ticks);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
+int lock_max_donation (struct thread *);
+
+#ifdef LOCKSTAT
+/* Gives every lock_init() call site its own lock_class, so that
+   lockstat reports contention by site. */
+void lock_init_class (struct lock *, struct lock_class *);
+#define lock_init(LOCK) ({                                          \
+	static struct lock_class lock_class_ =                          \
+		LOCK_CLASS_INITIALIZER (#LOCK);                             \
+	lock_init_class ((LOCK), &lock_class_);                         \
+})
+#endif
 
 /* Condition variable. */
 struct condition {
-	struct list waiters;        /* List of waiting threads. */
+	struct waitq waiters;       /* Waiting threads. */
 };
 
 void cond_init (struct condition *);
 void cond_wait (struct condition *, struct lock *);
+bool cond_wait_timeout (struct condition *, struct lock *, int64_t ticks);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/* Reader-writer lock. */
+struct rwlock {
+	struct lock lock;           /* Held by the writer. */
+	unsigned readers;           /* Readers holding the lock. */
+	unsigned writers;           /* Writers holding or waiting. */
+	struct waitq drain;         /* Writer waiting for readers to leave. */
+};
+
+void rwlock_init (struct rwlock *);
+void rwlock_read_acquire (struct rwlock *);
+void rwlock_read_release (struct rwlock *);
+void rwlock_write_acquire (struct rwlock *);
+void rwlock_write_release (struct rwlock *);
+bool rwlock_write_held_by_current_thread (const struct rwlock *);
+
+/* Spinlock.  Unlike the primitives above, which rely on turning
+   interrupts off, a spinlock also excludes other CPUs.  It does
+   not disable interrupts and may be used before the thread
+   system runs. */
+struct spinlock {
+	volatile int locked;        /* Nonzero while held. */
+};
+
+void spin_lock_init (struct spinlock *);
+void spin_lock (struct spinlock *);
+bool spin_try_lock (struct spinlock *);
+void spin_unlock (struct spinlock *);
+
+/* Sequence lock, for small read-mostly records.  Readers never
+   block or write; they retry if a writer intervened. */
+struct seqlock {
+	volatile unsigned seq;      /* Odd while a write is in progress. */
+	struct spinlock lock;       /* Serializes writers. */
+};
+
+void seqlock_init (struct seqlock *);
+unsigned seqlock_read_begin (const struct seqlock *);
+bool seqlock_read_retry (const struct seqlock *, unsigned seq);
+enum intr_level seqlock_write_begin (struct seqlock *);
+void seqlock_write_end (struct seqlock *, enum intr_level);
+
 
 
 /* Optimization barrier.
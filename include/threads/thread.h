@@ -3,9 +3,12 @@
 
 #include <debug.h>
 #include <list.h>
+#include <rbtree.h>
+#include <sched.h>
 #include <stdint.h>
 #include "threads/interrupt.h"
 #include "threads/synch.h"
+#include "devices/timer.h"
 #ifdef VM
 #include "vm/vm.h"
 #endif
@@ -29,16 +32,23 @@ typedef int pid_t;
 #define PRI_MIN 0                       /* Lowest priority. */
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
-#define MAX_FILES 128	 				/* PDG project2 파일 최대 갯수. */
+
+/* Nice values. */
+#define NICE_MIN -20                    /* Nicest (lowest CPU share). */
+#define NICE_MAX 20                     /* Least nice. */
 /* A kernel thread or user process.
  *
- * Each thread structure is stored in its own 4 kB page.  The
- * thread structure itself sits at the very bottom of the page
- * (at offset 0).  The rest of the page is reserved for the
- * thread's kernel stack, which grows downward from the top of
- * the page (at offset 4 kB).  Here's an illustration:
+ * Each thread structure is stored at the bottom of its own
+ * block of pages, which is aligned to its size so that the
+ * running thread can be found by rounding down the stack
+ * pointer.  The thread's kernel stack, thread_stack_pages pages
+ * (8 or 16 kB, see the "-kstack" option), sits at the top of the
+ * block and grows downward.  Between the two is a guard page
+ * that is left unmapped, so that a stack overflow faults before
+ * it can reach the thread structure.  Here's an illustration for
+ * an 8 kB stack:
  *
- *      4 kB +---------------------------------+
+ *     16 kB +---------------------------------+
  *           |          kernel stack           |
  *           |                |                |
  *           |                |                |
@@ -47,12 +57,9 @@ typedef int pid_t;
  *           |                                 |
  *           |                                 |
  *           |                                 |
- *           |                                 |
- *           |                                 |
- *           |                                 |
- *           |                                 |
- *           |                                 |
- *           +---------------------------------+
+ *      8 kB +---------------------------------+
+ *           |     guard page (not mapped)     |
+ *      4 kB +---------------------------------+
  *           |              magic              |
  *           |            intr_frame           |
  *           |                :                |
@@ -61,32 +68,39 @@ typedef int pid_t;
  *           |              status             |
  *      0 kB +---------------------------------+
  *
+ * Block sizes are powers of two, so with a 16 kB stack a block
+ * is 32 kB, and the pages above the stack are given back to the
+ * page allocator.  The initial thread, which runs on the boot
+ * stack, is the exception: it has a single 4 kB page with no
+ * guard.
+ *
  * The upshot of this is twofold:
  *
- *    1. First, `struct thread' must not be allowed to grow too
- *       big.  If it does, then there will not be enough room for
- *       the kernel stack.  Our base `struct thread' is only a
- *       few bytes in size.  It probably should stay well under 1
- *       kB.
+ *    1. First, `struct thread' must fit in its page.  Per-process
+ *       tables, such as the file descriptor table, should be
+ *       allocated separately rather than embedded.
  *
  *    2. Second, kernel stacks must not be allowed to grow too
- *       large.  If a stack overflows, it will corrupt the thread
- *       state.  Thus, kernel functions should not allocate large
- *       structures or arrays as non-static local variables.  Use
- *       dynamic allocation with malloc() or palloc_get_page()
- *       instead.
+ *       large.  An overflow into the guard page causes a page
+ *       fault that the CPU cannot deliver on the exhausted stack,
+ *       which becomes a double fault; with a TSS (userprog and
+ *       later projects) that runs on a stack of its own and
+ *       panics with "Kernel stack overflow".  An overflow that
+ *       jumps over the guard page will still corrupt the thread
+ *       state, so kernel functions should still not allocate
+ *       very large structures or arrays as non-static local
+ *       variables.
  *
- * The first symptom of either of these problems will probably be
- * an assertion failure in thread_current(), which checks that
- * the `magic' member of the running thread's `struct thread' is
- * set to THREAD_MAGIC.  Stack overflow will normally change this
- * value, triggering the assertion. */
+ * A corrupted thread structure will probably show up as an
+ * assertion failure in thread_current(), which checks that the
+ * `magic' member of the running thread's `struct thread' is set
+ * to THREAD_MAGIC. */
 /* The `elem' member has a dual purpose.  It can be an element in
- * the run queue (thread.c), or it can be an element in a
- * semaphore wait list (synch.c).  It can be used these two ways
- * only because they are mutually exclusive: only a thread in the
- * ready state is on the run queue, whereas only a thread in the
- * blocked state is on a semaphore wait list. */
+ * the run queue (thread.c), or, once the thread has died, an
+ * element in the cache of free thread blocks.  Threads blocked
+ * on a semaphore or condition variable (synch.c) instead wait in
+ * a wait queue through `w_elem', which stays separate because a
+ * blocked thread's position there must follow its priority. */
 struct thread {
 	/* Owned by thread.c. */
 	tid_t tid;                          /* Thread identifier. */
@@ -97,22 +111,41 @@ struct thread {
 	/* Shared between thread.c and synch.c. */
 	struct list_elem elem;              /* List element. */
 	
-	/* PDG 스레드를 깨울 시간 set : 1tick 10ms */
-	int64_t wakeup_tick;
 	/* PDG 원본 우선순위*/
 	int org_priority;
 	/* PDG 대기하고 있는 락*/
 	struct lock* wait_on_lock;			
-	/* PDG 해당 쓰레드에 걸린 multi 락 */
-	struct list donation;	 //d_elem1 d_elem2 d_elem3		 
-	/* PDG 도네이션용 엘리먼트 */
-	struct list_elem d_elem;              /* List element. */
+	/* PDG 보유 중인 락 목록. donation은 각 락 대기 큐의 맨 앞 스레드로 계산 */
+	struct list held_locks;
+	/* PDG 세마포어/조건변수 대기 큐(페어링 힙) 노드와 들어가 있는 큐 */
+	struct waitq_elem w_elem;
+	struct waitq *waitq;
+	/* PDG 읽기로 보유 중인 rwlock 수. 0이 아니면 대기 중인 writer를 앞지름 */
+	unsigned rw_reads;
 	/* PDG 전체리스트 엘리먼트 */
 	struct list_elem a_elem;              /* List element. */
 	/* PDG MLFQ 상냥함 구현 */
 	int nice;              /* List element. */
 	/* PDG MLFQ CPU 사용계수 구현 */
 	int recent_cpu;              /* List element. */
+	/* PDG MLFQ recent_cpu에 감쇠가 반영된 초 (block 중엔 밀림) */
+	int64_t mlfqs_epoch;
+	/* PDG 스케줄링 정책과 해당 클래스 */
+	enum sched_policy policy;
+	const struct sched_class *sched_class;
+	/* PDG CFS 가상 실행시간과 CFS/EDF run 큐(레드블랙트리) 엘리먼트 */
+	int64_t vruntime;
+	struct rb_elem rb_elem;
+	/* PDG EDF(SCHED_DEADLINE) 예약 (틱 단위)과 현재 주기 상태 */
+	int64_t dl_runtime;                 /* 주기당 실행 예산 */
+	int64_t dl_deadline;                /* 주기 시작부터 상대 데드라인 */
+	int64_t dl_period;                  /* 주기 */
+	int64_t dl_abs_deadline;            /* 현재 주기의 절대 데드라인 */
+	int64_t dl_budget;                  /* 남은 예산 */
+	bool dl_throttled;                  /* 예산 소진, 다음 주기까지 block */
+	struct timer_event dl_timer;        /* 다음 주기 시작 타이머 */
+	/* PDG 지금까지 사용한 CPU 시간 (나노초, 스레드 전환 때 계산) */
+	int64_t cpu_ns;
 
 	/* PDG project2 프로세스 id */
 	pid_t pid;
@@ -136,10 +169,8 @@ struct thread {
 	struct semaphore wait_sema_info;
 	/* PDG project2 if_ 정보 */
 	struct intr_frame if_;
-	/* PDG project2 FDT 제작 */
-	struct file *fdt[MAX_FILES];
-	/* PDG project2 다음 fd 번호 */
-	int next_fd;
+	/* PDG project2 FDT, 처음 파일을 열 때 따로 할당 (userprog/fdtable.c) */
+	struct fd_table *fdt;
 	/* PDG project2 실행중인 파일 */
 	struct file *running;
 	
@@ -153,28 +184,38 @@ struct thread {
 #endif
 
 	/* Owned by thread.c. */
+	uint8_t *stack;                     /* Saved stack pointer. */
 	struct intr_frame tf;               /* Information for switching */
 	unsigned magic;                     /* Detects stack overflow. */
 };
 
+/* PDG 커널 스택 페이지 수 (2 또는 4), 커널 옵션 "-kstack=KB" */
+extern size_t thread_stack_pages;
+
+/* PDG 재사용 스레드 블록 캐시 크기, 커널 옵션 "-tcache=N" */
+extern size_t thread_cache_max;
+
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
-int64_t global_ticks;
+/* PDG true이면 SCHED_NORMAL 스레드를 CFS(vruntime)로 스케줄링.
+   커널 옵션 "-sched=cfs"로 설정, -mlfqs보다 우선 */
+extern bool thread_cfs;
+
+/* PDG true이면 문맥교환에 switch_threads() 대신 예전 intr_frame + iretq
+   경로 사용. 커널 옵션 "-switch=iret"로 설정 */
+extern bool thread_iret_switch;
 
 
-int64_t get_globalticks(void);
 bool compare_priority(const struct list_elem *curr, const struct list_elem *new, void *aux UNUSED);
-bool compare_donation_priority(const struct list_elem *curr, const struct list_elem *new, void *aux UNUSED);
 
 void thread_init (void);
 void thread_start (void);
 
 /*PDG start*/
-void thread_wakeup(void);
-void thread_sleep(int64_t local_ticks);
+void thread_sleep(int64_t ticks);
 /*PDG end*/
 
 void thread_tick (void);
@@ -185,6 +226,7 @@ tid_t thread_create (const char *name, int priority, thread_func *, void *);
 
 void thread_block (void);
 void thread_unblock (struct thread *);
+void thread_wake (struct thread *);
 
 struct thread *thread_current (void);
 tid_t thread_tid (void);
@@ -200,8 +242,18 @@ int thread_get_nice (void);
 void thread_set_nice (int);
 int thread_get_recent_cpu (void);
 int thread_get_load_avg (void);
+int64_t thread_get_cpu_ns (void);
 
 void do_iret (struct intr_frame *tf);
 
+void *thread_stack_top (struct thread *);
+struct thread *thread_guard_owner (const void *va);
+bool thread_cache_reclaim (void);
+
 void priority_preemption(void);
+
+void thread_update_priority(struct thread *t, int priority);
+bool thread_set_sched (struct thread *, enum sched_policy, int priority);
+bool thread_set_deadline (struct thread *, int64_t runtime, int64_t deadline,
+		int64_t period);
 #endif /* threads/thread.h */
@@ -0,0 +1,47 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Deferred work.
+
+   Interrupt handlers run with interrupts off, so whatever they
+   do delays every other interrupt.  Work that need not happen in
+   the handler itself can be put in a struct work and deferred,
+   either to softirq_raise(), which runs it when the interrupt
+   returns, or to a workqueue, whose worker threads run it.
+   Either way it runs with interrupts on. */
+
+typedef void work_func (void *aux);
+
+/* A unit of deferred work. */
+struct work {
+	struct list_elem elem;      /* Element in a queue's pending list. */
+	work_func *func;            /* Function to call. */
+	void *aux;                  /* Argument for FUNC. */
+	struct workqueue *wq;       /* Queue last queued on. */
+	bool pending;               /* Queued but not started? */
+	unsigned running;           /* Number of runs in progress. */
+};
+
+void work_init (struct work *, work_func *, void *aux);
+
+/* A pool of kernel threads that run queued work in order. */
+struct workqueue {
+	char name[16];              /* Name, for the worker threads. */
+	struct list pending;        /* Queued work. */
+	struct list idle;           /* Workers waiting for work. */
+	struct list flushers;       /* Threads waiting in flush_work(). */
+};
+
+void workqueue_init (void);
+struct workqueue *workqueue_create (const char *name, int priority,
+		size_t workers);
+bool queue_work (struct workqueue *, struct work *);
+bool softirq_raise (struct work *);
+void flush_work (struct work *);
+void softirq_run (void);
+
+#endif /* threads/workqueue.h */
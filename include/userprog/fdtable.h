@@ -0,0 +1,31 @@
+#ifndef USERPROG_FDTABLE_H
+#define USERPROG_FDTABLE_H
+
+#include <stdbool.h>
+
+struct file;
+
+/* Largest number of file descriptors a process may have. */
+#define FD_MAX 128
+
+/* First descriptor handed out.  0 and 1 are the console. */
+#define FD_MIN 2
+
+/* A process's file descriptor table, mapping descriptors to
+   open files.  Allocated separately from struct thread, only once
+   a process first opens a file, and grown as needed. */
+struct fd_table {
+	struct file **files;        /* files[fd], or null if fd is free. */
+	int size;                   /* Number of elements in FILES. */
+	int next_fd;                /* No free descriptor below this. */
+};
+
+struct fd_table *fd_table_create (void);
+struct fd_table *fd_table_duplicate (const struct fd_table *);
+void fd_table_destroy (struct fd_table *);
+
+int fd_table_install (struct fd_table *, struct file *);
+struct file *fd_table_get (const struct fd_table *, int fd);
+struct file *fd_table_remove (struct fd_table *, int fd);
+
+#endif /* userprog/fdtable.h */
@@ -22,6 +22,9 @@ struct task_state {
 	uint16_t iomb;
 }__attribute__ ((packed));
 
+/* Interrupt stack table entry used for double faults. */
+#define TSS_IST_DF 1
+
 struct task_state;
 void tss_init (void);
 struct task_state *tss_get (void);
@@ -0,0 +1,307 @@
+#include "rbtree.h"
+#include "../debug.h"
+
+/* Red-black tree, following the algorithms in [CLRS] chapter 13,
+   "Red-Black Trees", with null pointers in place of the
+   sentinel leaf.  A null child counts as black. */
+
+static void rotate_left (struct rbtree *, struct rb_elem *);
+static void rotate_right (struct rbtree *, struct rb_elem *);
+static void transplant (struct rbtree *, struct rb_elem *, struct rb_elem *);
+static void insert_fixup (struct rbtree *, struct rb_elem *);
+static void remove_fixup (struct rbtree *, struct rb_elem *,
+		struct rb_elem *);
+
+/* Returns true if E is a red node, false if it is black or
+   null. */
+static inline bool
+is_red (const struct rb_elem *e) {
+	return e != NULL && e->red;
+}
+
+/* Returns the leftmost element of the subtree rooted at E. */
+static struct rb_elem *
+subtree_min (struct rb_elem *e) {
+	while (e->left != NULL)
+		e = e->left;
+	return e;
+}
+
+/* Initializes TREE as an empty tree ordered by LESS, given
+   auxiliary data AUX. */
+void
+rb_init (struct rbtree *tree, rb_less_func *less, void *aux) {
+	ASSERT (tree != NULL);
+	ASSERT (less != NULL);
+
+	tree->root = NULL;
+	tree->min = NULL;
+	tree->elem_cnt = 0;
+	tree->less = less;
+	tree->aux = aux;
+}
+
+/* Inserts ELEM into TREE.  ELEM goes after any elements that
+   compare equal to it. */
+void
+rb_insert (struct rbtree *tree, struct rb_elem *elem) {
+	struct rb_elem **link = &tree->root;
+	struct rb_elem *parent = NULL;
+	bool leftmost = true;
+
+	ASSERT (elem != NULL);
+
+	while (*link != NULL) {
+		parent = *link;
+		if (tree->less (elem, parent, tree->aux))
+			link = &parent->left;
+		else {
+			link = &parent->right;
+			leftmost = false;
+		}
+	}
+
+	elem->parent = parent;
+	elem->left = elem->right = NULL;
+	elem->red = true;
+	*link = elem;
+	if (leftmost)
+		tree->min = elem;
+	tree->elem_cnt++;
+
+	insert_fixup (tree, elem);
+}
+
+/* Removes ELEM, which must be in TREE, from TREE. */
+void
+rb_remove (struct rbtree *tree, struct rb_elem *elem) {
+	struct rb_elem *y = elem;
+	struct rb_elem *x, *x_parent;
+	bool removed_red = y->red;
+
+	ASSERT (tree->elem_cnt > 0);
+
+	if (tree->min == elem)
+		tree->min = rb_next (elem);
+
+	if (elem->left == NULL) {
+		x = elem->right;
+		x_parent = elem->parent;
+		transplant (tree, elem, elem->right);
+	} else if (elem->right == NULL) {
+		x = elem->left;
+		x_parent = elem->parent;
+		transplant (tree, elem, elem->left);
+	} else {
+		/* Replace ELEM by its successor Y. */
+		y = subtree_min (elem->right);
+		removed_red = y->red;
+		x = y->right;
+		if (y->parent == elem)
+			x_parent = y;
+		else {
+			x_parent = y->parent;
+			transplant (tree, y, y->right);
+			y->right = elem->right;
+			y->right->parent = y;
+		}
+		transplant (tree, elem, y);
+		y->left = elem->left;
+		y->left->parent = y;
+		y->red = elem->red;
+	}
+	tree->elem_cnt--;
+
+	if (!removed_red)
+		remove_fixup (tree, x, x_parent);
+}
+
+/* Returns the smallest element in TREE, or a null pointer if
+   TREE is empty. */
+struct rb_elem *
+rb_min (const struct rbtree *tree) {
+	return tree->min;
+}
+
+/* Returns the element that follows E in its tree, or a null
+   pointer if E is the largest element. */
+struct rb_elem *
+rb_next (struct rb_elem *e) {
+	struct rb_elem *parent;
+
+	if (e->right != NULL)
+		return subtree_min (e->right);
+
+	parent = e->parent;
+	while (parent != NULL && e == parent->right) {
+		e = parent;
+		parent = parent->parent;
+	}
+	return parent;
+}
+
+/* Returns the number of elements in TREE. */
+size_t
+rb_size (const struct rbtree *tree) {
+	return tree->elem_cnt;
+}
+
+/* Returns true if TREE contains no elements. */
+bool
+rb_empty (const struct rbtree *tree) {
+	return tree->elem_cnt == 0;
+}
+
+/* Rotates the subtree rooted at X to the left, so that its
+   right child becomes the root of the subtree. */
+static void
+rotate_left (struct rbtree *tree, struct rb_elem *x) {
+	struct rb_elem *y = x->right;
+
+	x->right = y->left;
+	if (y->left != NULL)
+		y->left->parent = x;
+	transplant (tree, x, y);
+	y->left = x;
+	x->parent = y;
+}
+
+/* Rotates the subtree rooted at X to the right, so that its
+   left child becomes the root of the subtree. */
+static void
+rotate_right (struct rbtree *tree, struct rb_elem *x) {
+	struct rb_elem *y = x->left;
+
+	x->left = y->right;
+	if (y->right != NULL)
+		y->right->parent = x;
+	transplant (tree, x, y);
+	y->right = x;
+	x->parent = y;
+}
+
+/* Puts V, which may be null, in U's place under U's parent. */
+static void
+transplant (struct rbtree *tree, struct rb_elem *u, struct rb_elem *v) {
+	if (u->parent == NULL)
+		tree->root = v;
+	else if (u == u->parent->left)
+		u->parent->left = v;
+	else
+		u->parent->right = v;
+	if (v != NULL)
+		v->parent = u->parent;
+}
+
+/* Restores the red-black properties after inserting red node X. */
+static void
+insert_fixup (struct rbtree *tree, struct rb_elem *x) {
+	struct rb_elem *p;
+
+	while (is_red (p = x->parent)) {
+		/* P is red, so it is not the root and has a parent. */
+		struct rb_elem *g = p->parent;
+
+		if (p == g->left) {
+			struct rb_elem *u = g->right;
+
+			if (is_red (u)) {
+				p->red = u->red = false;
+				g->red = true;
+				x = g;
+				continue;
+			}
+			if (x == p->right) {
+				rotate_left (tree, p);
+				x = p;
+				p = x->parent;
+			}
+			p->red = false;
+			g->red = true;
+			rotate_right (tree, g);
+		} else {
+			struct rb_elem *u = g->left;
+
+			if (is_red (u)) {
+				p->red = u->red = false;
+				g->red = true;
+				x = g;
+				continue;
+			}
+			if (x == p->left) {
+				rotate_right (tree, p);
+				x = p;
+				p = x->parent;
+			}
+			p->red = false;
+			g->red = true;
+			rotate_left (tree, g);
+		}
+	}
+	tree->root->red = false;
+}
+
+/* Restores the red-black properties after removing a black
+   node.  X, which may be null, carries the extra black, and
+   PARENT is its parent. */
+static void
+remove_fixup (struct rbtree *tree, struct rb_elem *x,
+		struct rb_elem *parent) {
+	while (x != tree->root && !is_red (x)) {
+		if (x == parent->left) {
+			struct rb_elem *w = parent->right;
+
+			if (is_red (w)) {
+				w->red = false;
+				parent->red = true;
+				rotate_left (tree, parent);
+				w = parent->right;
+			}
+			if (!is_red (w->left) && !is_red (w->right)) {
+				w->red = true;
+				x = parent;
+				parent = x->parent;
+			} else {
+				if (!is_red (w->right)) {
+					w->left->red = false;
+					w->red = true;
+					rotate_right (tree, w);
+					w = parent->right;
+				}
+				w->red = parent->red;
+				parent->red = false;
+				w->right->red = false;
+				rotate_left (tree, parent);
+				x = tree->root;
+			}
+		} else {
+			struct rb_elem *w = parent->left;
+
+			if (is_red (w)) {
+				w->red = false;
+				parent->red = true;
+				rotate_right (tree, parent);
+				w = parent->left;
+			}
+			if (!is_red (w->left) && !is_red (w->right)) {
+				w->red = true;
+				x = parent;
+				parent = x->parent;
+			} else {
+				if (!is_red (w->left)) {
+					w->right->red = false;
+					w->red = true;
+					rotate_left (tree, w);
+					w = parent->left;
+				}
+				w->red = parent->red;
+				parent->red = false;
+				w->left->red = false;
+				rotate_right (tree, parent);
+				x = tree->root;
+			}
+		}
+	}
+	if (x != NULL)
+		x->red = false;
+}
@@ -194,3 +194,23 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+int
+sched_setscheduler (int policy, int priority) {
+	return syscall2 (SYS_SCHED_SETSCHEDULER, policy, priority);
+}
+
+int
+sched_setdeadline (int64_t runtime, int64_t deadline, int64_t period) {
+	return syscall3 (SYS_SCHED_SETDEADLINE, runtime, deadline, period);
+}
+
+int
+lockstat (struct lockstat *buf, int cnt) {
+	return syscall2 (SYS_LOCKSTAT, buf, cnt);
+}
+
+int
+nanosleep (int64_t ns) {
+	return syscall1 (SYS_NANOSLEEP, ns);
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my ($rounds) = scalar (grep (/round \d+: \d+ cycles\/switch/, @output));
+fail "Expected 3 benchmark rounds, got $rounds.\n" if $rounds != 3;
+pass;
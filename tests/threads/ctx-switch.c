@@ -0,0 +1,76 @@
+/* Measures the cost of a kernel-to-kernel context switch.
+
+   Two threads of equal priority ping-pong on a pair of
+   semaphores, as in sema_self_test(), so that every sema_down()
+   blocks and switches to the other thread.  Each round times
+   ITER_CNT round trips, two switches each, with the TSC.
+
+   ctx-switch uses switch_threads(), the default, and
+   ctx-switch-iret runs the same code under -switch=iret, which
+   saves a full intr_frame and switches with iretq, so that the
+   two outputs can be compared.  The numbers depend on the
+   machine, so the tests only check that every round reports. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define ROUND_CNT 3
+#define ITER_CNT 10000
+
+static struct semaphore sema[2];
+
+static void run_ctx_switch (void);
+static void pong_thread (void *aux);
+
+void
+test_ctx_switch (void) 
+{
+  ASSERT (!thread_iret_switch);
+  run_ctx_switch ();
+}
+
+void
+test_ctx_switch_iret (void) 
+{
+  ASSERT (thread_iret_switch);
+  run_ctx_switch ();
+}
+
+static void
+run_ctx_switch (void) 
+{
+  int round, i;
+
+  sema_init (&sema[0], 0);
+  sema_init (&sema[1], 0);
+  thread_create ("pong", PRI_DEFAULT, pong_thread, NULL);
+
+  for (round = 0; round < ROUND_CNT; round++) 
+    {
+      uint64_t start = rdtsc ();
+
+      for (i = 0; i < ITER_CNT; i++) 
+        {
+          sema_up (&sema[0]);
+          sema_down (&sema[1]);
+        }
+      msg ("round %d: %llu cycles/switch", round,
+           (unsigned long long) (rdtsc () - start) / (2 * ITER_CNT));
+    }
+}
+
+static void
+pong_thread (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < ROUND_CNT * ITER_CNT; i++) 
+    {
+      sema_down (&sema[0]);
+      sema_up (&sema[1]);
+    }
+}
@@ -0,0 +1,66 @@
+/* Checks admission control for the earliest-deadline-first
+   class.  With the default limit of 95%, deadline threads may
+   reserve at most 95% of the CPU in total.  Requests that would
+   go over it, or that are malformed, must be rejected without
+   changing anything, and a thread's bandwidth must be returned
+   when it changes its reservation, leaves the class or exits. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/sched.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static struct semaphore done;
+
+static void
+try (struct thread *t, int64_t runtime, int64_t deadline, int64_t period) 
+{
+  msg ("%s: %lld/%lld/%lld %s.", t->name,
+       (long long) runtime, (long long) deadline, (long long) period,
+       thread_set_deadline (t, runtime, deadline, period)
+       ? "admitted" : "rejected");
+}
+
+static void
+child_thread (void *aux UNUSED) 
+{
+  struct thread *t = thread_current ();
+
+  try (t, 5, 10, 10);
+  try (t, 4, 10, 10);
+  sema_up (&done);
+}
+
+void
+test_edf_admit (void) 
+{
+  struct thread *t = thread_current ();
+
+  ASSERT (sched_dl_bw_limit == 95);
+
+  sema_init (&done, 0);
+
+  msg ("Malformed reservations.");
+  try (t, 0, 10, 10);
+  try (t, 5, 4, 10);
+  try (t, 5, 20, 10);
+
+  msg ("Filling up to the limit.");
+  try (t, 5, 10, 10);
+  thread_create ("child", PRI_DEFAULT, child_thread, NULL);
+  sema_down (&done);
+  timer_sleep (1);
+
+  msg ("The child has exited, returning its bandwidth.");
+  try (t, 9, 10, 10);
+  try (t, 96, 100, 100);
+  try (t, 95, 100, 100);
+
+  msg ("Leaving the class returns the bandwidth.");
+  thread_set_sched (t, SCHED_NORMAL, PRI_DEFAULT);
+  try (t, 95, 100, 100);
+  thread_set_sched (t, SCHED_NORMAL, PRI_DEFAULT);
+}
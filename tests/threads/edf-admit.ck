@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf-admit) begin
+(edf-admit) Malformed reservations.
+(edf-admit) main: 0/10/10 rejected.
+(edf-admit) main: 5/4/10 rejected.
+(edf-admit) main: 5/20/10 rejected.
+(edf-admit) Filling up to the limit.
+(edf-admit) main: 5/10/10 admitted.
+(edf-admit) child: 5/10/10 rejected.
+(edf-admit) child: 4/10/10 admitted.
+(edf-admit) The child has exited, returning its bandwidth.
+(edf-admit) main: 9/10/10 admitted.
+(edf-admit) main: 96/100/100 rejected.
+(edf-admit) main: 95/100/100 admitted.
+(edf-admit) Leaving the class returns the bandwidth.
+(edf-admit) main: 95/100/100 admitted.
+(edf-admit) end
+EOF
+pass;
@@ -0,0 +1,136 @@
+/* Runs periodic deadline threads next to CPU-bound normal
+   threads and counts the jobs that finish after their deadlines.
+
+   Three deadline threads reserve 2 ticks in 10, 3 in 20 and 5
+   in 50, and each of their jobs does one tick less work than the
+   reservation, so none of them should miss a deadline.  A fourth
+   deadline thread reserves 2 ticks in 10 but spins without
+   stopping, so it must be throttled to about 20% of the CPU,
+   without making the others miss.  Four normal threads soak up
+   whatever CPU is left. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define RUN_TICKS (3 * TIMER_FREQ)      /* Length of the test. */
+#define HOG_CNT 4
+
+struct periodic 
+  {
+    const char *name;
+    int64_t runtime;                    /* Reserved ticks per period. */
+    int64_t period;                     /* Period, and deadline. */
+    int jobs;                           /* Jobs completed. */
+    int misses;                         /* Jobs completed late. */
+  };
+
+static struct periodic periodics[] = 
+  {
+    {"dl 2/10", 2, 10, 0, 0},
+    {"dl 3/20", 3, 20, 0, 0},
+    {"dl 5/50", 5, 50, 0, 0},
+  };
+#define PERIODIC_CNT (sizeof periodics / sizeof *periodics)
+
+static int64_t start_time;
+static int overrun_ticks;
+static struct semaphore done;
+
+static void periodic_thread (void *aux);
+static void overrun_thread (void *aux);
+static void hog_thread (void *aux);
+static void spin_ticks (int ticks);
+
+void
+test_edf_mixed (void) 
+{
+  size_t i;
+
+  sema_init (&done, 0);
+
+  /* Give every thread time to set itself up before the first
+     period starts. */
+  start_time = timer_ticks () + 10;
+  for (i = 0; i < PERIODIC_CNT; i++)
+    thread_create (periodics[i].name, PRI_DEFAULT, periodic_thread,
+                   &periodics[i]);
+  thread_create ("overrun", PRI_DEFAULT, overrun_thread, NULL);
+  for (i = 0; i < HOG_CNT; i++)
+    thread_create ("hog", PRI_DEFAULT, hog_thread, NULL);
+
+  for (i = 0; i < PERIODIC_CNT + 1 + HOG_CNT; i++)
+    sema_down (&done);
+
+  for (i = 0; i < PERIODIC_CNT; i++)
+    msg ("%s: %d jobs, %d deadline misses.",
+         periodics[i].name, periodics[i].jobs, periodics[i].misses);
+  msg ("overrun 2/10: ran %d of %d ticks.", overrun_ticks, RUN_TICKS);
+}
+
+static void
+periodic_thread (void *p_) 
+{
+  struct periodic *p = p_;
+  int64_t release = start_time;
+
+  if (!thread_set_deadline (thread_current (), p->runtime, p->period,
+                            p->period))
+    fail ("%s: reservation rejected", p->name);
+
+  while (release + p->period <= start_time + RUN_TICKS) 
+    {
+      timer_sleep (release - timer_ticks ());
+      spin_ticks (p->runtime - 1);
+      p->jobs++;
+      if (timer_ticks () > release + p->period)
+        p->misses++;
+      release += p->period;
+    }
+  sema_up (&done);
+}
+
+static void
+overrun_thread (void *aux UNUSED) 
+{
+  int64_t last_time = 0;
+
+  if (!thread_set_deadline (thread_current (), 2, 10, 10))
+    fail ("overrun: reservation rejected");
+
+  timer_sleep (start_time - timer_ticks ());
+  while (timer_elapsed (start_time) < RUN_TICKS) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        overrun_ticks++;
+      last_time = cur_time;
+    }
+  sema_up (&done);
+}
+
+static void
+hog_thread (void *aux UNUSED) 
+{
+  while (timer_elapsed (start_time) < RUN_TICKS)
+    continue;
+  sema_up (&done);
+}
+
+/* Busy-waits until TICKS timer ticks have gone by while running. */
+static void
+spin_ticks (int ticks) 
+{
+  int64_t last_time = timer_ticks ();
+
+  while (ticks > 0) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ticks--;
+      last_time = cur_time;
+    }
+}
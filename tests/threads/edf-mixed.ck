@@ -0,0 +1,24 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+my (@periodic) = grep (/dl \d+\/\d+: \d+ jobs, \d+ deadline misses\./, @output);
+fail "Expected 3 periodic threads, got " . scalar (@periodic) . ".\n"
+  if @periodic != 3;
+foreach (@periodic) {
+    my ($misses) = /(\d+) deadline misses/;
+    fail "Deadline thread missed deadlines: $_\n" if $misses != 0;
+}
+
+my ($ran) = join ('', @output) =~ /overrun 2\/10: ran (\d+) of \d+ ticks\./
+  or fail "Missing overrun thread report.\n";
+fail "Throttled thread ran $ran of 300 ticks, expected about 60.\n"
+  if $ran < 40 || $ran > 80;
+pass;
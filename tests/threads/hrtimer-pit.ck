@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(hrtimer-pit) begin
+(hrtimer-pit) hrtimer_sleep() slept long enough.
+(hrtimer-pit) Timers fired in order of expiry, none early.
+(hrtimer-pit) Cancelled timer did not fire.
+(hrtimer-pit) Callback re-armed its own timer.
+(hrtimer-pit) end
+EOF
+pass;
@@ -0,0 +1,107 @@
+/* Checks high-resolution timers.  Timers must fire in order of
+   expiry and never early, a cancelled timer must not fire, a
+   callback may re-arm its own timer, and hrtimer_sleep() must
+   sleep at least as long as asked.  hrtimer-pit runs the same
+   checks with -nolapic, where timers fire at PIT ticks. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "devices/hrtimer.h"
+#include "devices/timer.h"
+
+#define TIMER_CNT 3
+
+struct probe 
+  {
+    struct hrtimer timer;
+    int id;
+    int64_t fired_at;
+    int rearm;
+  };
+
+static int order[TIMER_CNT];
+static int order_cnt;
+
+static void
+record (void *probe_) 
+{
+  struct probe *p = probe_;
+
+  p->fired_at = timer_now_ns ();
+  if (order_cnt < TIMER_CNT)
+    order[order_cnt++] = p->id;
+}
+
+static void
+rearm (void *probe_) 
+{
+  struct probe *p = probe_;
+
+  if (--p->rearm > 0)
+    hrtimer_start (&p->timer, timer_now_ns () + 100 * 1000);
+}
+
+static void
+check_hrtimers (void) 
+{
+  static const int delay_us[TIMER_CNT] = {3000, 1000, 2000};
+  struct probe probes[TIMER_CNT];
+  struct probe cancelled, periodic;
+  int64_t start;
+  int i;
+
+  start = timer_now_ns ();
+  for (i = 0; i < TIMER_CNT; i++) 
+    {
+      probes[i].id = i;
+      probes[i].fired_at = 0;
+      hrtimer_setup (&probes[i].timer, record, &probes[i]);
+      hrtimer_start (&probes[i].timer, start + delay_us[i] * 1000);
+    }
+  cancelled.fired_at = 0;
+  hrtimer_setup (&cancelled.timer, record, &cancelled);
+  hrtimer_start (&cancelled.timer, start + 1500 * 1000);
+  if (!hrtimer_cancel (&cancelled.timer))
+    fail ("cancelling a pending timer returned false.");
+
+  hrtimer_sleep (5 * 1000 * 1000);
+  if (timer_now_ns () - start < 5 * 1000 * 1000)
+    fail ("hrtimer_sleep() returned early.");
+  msg ("hrtimer_sleep() slept long enough.");
+
+  if (order_cnt != TIMER_CNT)
+    fail ("%d of %d timers fired.", order_cnt, TIMER_CNT);
+  if (order[0] != 1 || order[1] != 2 || order[2] != 0)
+    fail ("timers fired in order %d %d %d.", order[0], order[1], order[2]);
+  for (i = 0; i < TIMER_CNT; i++)
+    if (probes[i].fired_at < start + delay_us[i] * 1000)
+      fail ("timer %d fired early.", i);
+  msg ("Timers fired in order of expiry, none early.");
+
+  if (cancelled.fired_at != 0)
+    fail ("cancelled timer fired.");
+  msg ("Cancelled timer did not fire.");
+
+  periodic.rearm = 5;
+  hrtimer_setup (&periodic.timer, rearm, &periodic);
+  hrtimer_start (&periodic.timer, timer_now_ns ());
+  timer_sleep (10);
+  if (periodic.rearm != 0)
+    fail ("re-armed timer fired %d of 5 times.", 5 - periodic.rearm);
+  msg ("Callback re-armed its own timer.");
+}
+
+void
+test_hrtimer (void) 
+{
+  check_hrtimers ();
+}
+
+void
+test_hrtimer_pit (void) 
+{
+  ASSERT (!hrtimer_is_oneshot ());
+  check_hrtimers ();
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(hrtimer) begin
+(hrtimer) hrtimer_sleep() slept long enough.
+(hrtimer) Timers fired in order of expiry, none early.
+(hrtimer) Cancelled timer did not fire.
+(hrtimer) Callback re-armed its own timer.
+(hrtimer) end
+EOF
+pass;
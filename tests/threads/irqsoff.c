@@ -0,0 +1,60 @@
+/* Checks the irqsoff tracer, which must be enabled with
+   -irqsoff.  A section that busy-waits with interrupts off must
+   be recorded as at least as long as the wait, whether it turns
+   interrupts off with intr_disable() or intr_set_level(), and
+   shorter sections must not displace it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/irqsoff.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+/* Length of the busy-wait, in TSC cycles. */
+#define BUSY_CYCLES 10000000
+
+static void
+busy_wait (uint64_t cycles) 
+{
+  uint64_t start = rdtsc ();
+
+  while (rdtsc () - start < cycles)
+    continue;
+}
+
+void
+test_irqsoff (void) 
+{
+  enum intr_level old_level;
+  int i;
+
+  ASSERT (irqsoff_enabled);
+
+  intr_disable ();
+  busy_wait (BUSY_CYCLES);
+  intr_enable ();
+  if (irqsoff_worst () < BUSY_CYCLES)
+    fail ("longest section %llu cycles, expected at least %d.",
+          (unsigned long long) irqsoff_worst (), BUSY_CYCLES);
+  msg ("Recorded section turned off by intr_disable().");
+
+  old_level = intr_set_level (INTR_OFF);
+  busy_wait (2 * BUSY_CYCLES);
+  intr_set_level (old_level);
+  if (irqsoff_worst () < 2 * BUSY_CYCLES)
+    fail ("longest section %llu cycles, expected at least %d.",
+          (unsigned long long) irqsoff_worst (), 2 * BUSY_CYCLES);
+  msg ("Recorded section turned off by intr_set_level().");
+
+  for (i = 0; i < 100; i++) 
+    {
+      old_level = intr_disable ();
+      intr_set_level (old_level);
+    }
+  timer_sleep (5);
+  if (irqsoff_worst () < 2 * BUSY_CYCLES)
+    fail ("short sections displaced the longest one.");
+  msg ("Longest section kept.");
+}
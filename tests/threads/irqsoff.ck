@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(irqsoff) begin
+(irqsoff) Recorded section turned off by intr_disable().
+(irqsoff) Recorded section turned off by intr_set_level().
+(irqsoff) Longest section kept.
+(irqsoff) end
+EOF
+pass;
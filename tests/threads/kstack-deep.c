@@ -0,0 +1,41 @@
+/* Checks that a kernel thread has more than a page of stack.
+   The thread fills a 6 kB local array, which would have run
+   over its struct thread when each thread had a single 4 kB
+   page, and then checks that both survived. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+#define BUF_SIZE 6144
+
+static struct semaphore done;
+
+static void
+deep_thread (void *aux UNUSED) 
+{
+  volatile char buf[BUF_SIZE];
+  size_t i;
+
+  for (i = 0; i < BUF_SIZE; i++)
+    buf[i] = i % 251;
+  for (i = 0; i < BUF_SIZE; i++)
+    if (buf[i] != (char) (i % 251))
+      fail ("stack buffer corrupted at offset %zu", i);
+
+  /* thread_current() checks the thread's magic number. */
+  msg ("%s: used a %d-byte stack buffer.", thread_current ()->name,
+       BUF_SIZE);
+  sema_up (&done);
+}
+
+void
+test_kstack_deep (void) 
+{
+  sema_init (&done, 0);
+  thread_create ("deep", PRI_DEFAULT, deep_thread, NULL);
+  sema_down (&done);
+}
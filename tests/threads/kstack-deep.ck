@@ -0,0 +1,10 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(kstack-deep) begin
+(kstack-deep) deep: used a 6144-byte stack buffer.
+(kstack-deep) end
+EOF
+pass;
@@ -0,0 +1,13 @@
+sub check_sched_latency {
+    our ($test);
+
+    my (@output) = read_text_file ("$test.output");
+    common_checks ("run", @output);
+    @output = get_core_output ("run", @output);
+
+    my ($rounds) = scalar (grep (/\d+ hogs: wakeup latency p50 \d+ p99 \d+ max \d+ ticks; turnaround p50 \d+ p99 \d+ max \d+ ticks/, @output));
+    fail "Expected 3 benchmark rounds, got $rounds.\n" if $rounds != 3;
+    pass;
+}
+
+1;
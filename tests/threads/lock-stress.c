@@ -0,0 +1,98 @@
+/* Stresses a lock with 256 contenders of mixed priorities.
+
+   The main thread acquires the lock and creates the contenders
+   in nondecreasing order of priority, all above its own, yielding
+   after each so that it blocks on the lock right away and donates
+   its priority to the main thread.  When the main thread releases
+   the lock, the contenders must get it in decreasing order of
+   priority, and in order of arrival among equal priorities.
+
+   Reports the average cost, in TSC cycles, of a contender
+   blocking on the lock, including donation, and of handing the
+   lock from one contender to the next.  The numbers depend on
+   the machine, so only the order is checked. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define CONTENDER_CNT 256
+#define PRI_LEVELS (PRI_MAX - PRI_DEFAULT)
+
+struct contender 
+  {
+    int id;
+    int priority;
+  };
+
+static struct lock lock;
+static struct contender contenders[CONTENDER_CNT];
+static int order[CONTENDER_CNT];
+static int order_cnt;
+
+static thread_func contender_thread;
+
+void
+test_lock_stress (void) 
+{
+  uint64_t start, blocked, released;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  lock_init (&lock);
+  lock_acquire (&lock);
+
+  start = rdtsc ();
+  for (i = 0; i < CONTENDER_CNT; i++) 
+    {
+      struct contender *c = &contenders[i];
+      char name[16];
+
+      c->id = i;
+      c->priority = PRI_DEFAULT + 1 + i * PRI_LEVELS / CONTENDER_CNT;
+      snprintf (name, sizeof name, "contender %d", i);
+      thread_create (name, c->priority, contender_thread, c);
+      thread_yield ();
+    }
+  blocked = rdtsc ();
+  if (thread_get_priority () != contenders[CONTENDER_CNT - 1].priority)
+    fail ("main thread has priority %d, expected %d.",
+          thread_get_priority (), contenders[CONTENDER_CNT - 1].priority);
+
+  lock_release (&lock);
+  released = rdtsc ();
+  if (order_cnt != CONTENDER_CNT)
+    fail ("only %d of %d contenders got the lock.", order_cnt, CONTENDER_CNT);
+
+  for (i = 1; i < CONTENDER_CNT; i++) 
+    {
+      struct contender *a = &contenders[order[i - 1]];
+      struct contender *b = &contenders[order[i]];
+
+      if (a->priority < b->priority
+          || (a->priority == b->priority && a->id > b->id))
+        fail ("contender %d (priority %d) got the lock before "
+              "contender %d (priority %d).",
+              a->id, a->priority, b->id, b->priority);
+    }
+  msg ("Contenders got the lock in priority order.");
+  msg ("block: %llu cycles/contender",
+       (unsigned long long) (blocked - start) / CONTENDER_CNT);
+  msg ("handoff: %llu cycles/contender",
+       (unsigned long long) (released - blocked) / CONTENDER_CNT);
+}
+
+static void
+contender_thread (void *c_) 
+{
+  struct contender *c = c_;
+
+  lock_acquire (&lock);
+  order[order_cnt++] = c->id;
+  lock_release (&lock);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+fail "Contenders did not get the lock in priority order.\n"
+  if !grep (/Contenders got the lock in priority order\./, @output);
+foreach my $phase ('block', 'handoff') {
+    fail "Missing $phase timing.\n"
+      if !grep (/$phase: \d+ cycles\/contender/, @output);
+}
+pass;
@@ -0,0 +1,76 @@
+/* Checks that realloc() resizes blocks in place when it can and
+   that malloc() reuses freed big blocks.  A small block must stay
+   put while it fits its size class, and a big block must shrink
+   in place and then grow back into the pages it just gave up,
+   keeping its contents throughout. */
+
+#include <stdio.h>
+#include <string.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/malloc.h"
+#include "threads/vaddr.h"
+
+static void
+fill (uint8_t *p, size_t size) 
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    p[i] = i % 251;
+}
+
+static void
+check (const uint8_t *p, size_t size) 
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    if (p[i] != i % 251)
+      fail ("byte %zu changed from %zu to %d.", i, i % 251, p[i]);
+}
+
+void
+test_malloc_realloc (void) 
+{
+  uint8_t *p;
+  uintptr_t addr;
+
+  p = malloc (20);
+  addr = (uintptr_t) p;
+  fill (p, 20);
+  p = realloc (p, 30);
+  if ((uintptr_t) p != addr)
+    fail ("small block moved when growing within its size class.");
+  p = realloc (p, 17);
+  if ((uintptr_t) p != addr)
+    fail ("small block moved when shrinking within its size class.");
+  check (p, 17);
+  free (p);
+  msg ("Small block resized in place.");
+
+  p = malloc (3 * PGSIZE);
+  addr = (uintptr_t) p;
+  fill (p, 3 * PGSIZE);
+  p = realloc (p, PGSIZE);
+  if ((uintptr_t) p != addr)
+    fail ("big block moved when shrinking.");
+  check (p, PGSIZE);
+  msg ("Big block shrunk in place.");
+
+  p = realloc (p, 3 * PGSIZE);
+  if ((uintptr_t) p != addr)
+    fail ("big block moved when growing into free pages.");
+  check (p, PGSIZE);
+  msg ("Big block grown in place.");
+  free (p);
+
+  p = malloc (2 * PGSIZE);
+  addr = (uintptr_t) p;
+  free (p);
+  p = malloc (2 * PGSIZE);
+  if ((uintptr_t) p != addr)
+    fail ("freed big block was not reused.");
+  free (p);
+  msg ("Freed big block reused.");
+}
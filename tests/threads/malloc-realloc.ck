@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(malloc-realloc) begin
+(malloc-realloc) Small block resized in place.
+(malloc-realloc) Big block shrunk in place.
+(malloc-realloc) Big block grown in place.
+(malloc-realloc) Freed big block reused.
+(malloc-realloc) end
+EOF
+pass;
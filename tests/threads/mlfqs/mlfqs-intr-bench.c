@@ -0,0 +1,76 @@
+/* Measures the cost of the timer interrupt under the MLFQS
+   scheduler as the number of runnable threads grows.
+
+   Each round starts THREAD_CNT spinning threads, as in
+   mlfqs-load-60, and samples the timer interrupt over a few
+   seconds, so that the once-per-second recomputation of
+   recent_cpu and priority is included.  The average and maximum
+   cycles per tick, and per recomputing tick, are printed for
+   each thread count.  The numbers are machine dependent, so the
+   test only checks that every round reports. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static const int thread_cnts[] = {1, 8, 16, 32, 60, 120};
+
+static int64_t spin_until;
+static struct semaphore done;
+
+static void load_thread (void *aux);
+
+void
+test_mlfqs_intr_bench (void) 
+{
+  size_t round;
+
+  ASSERT (thread_mlfqs);
+
+  sema_init (&done, 0);
+  for (round = 0; round < sizeof thread_cnts / sizeof *thread_cnts; round++)
+    {
+      int thread_cnt = thread_cnts[round];
+      struct timer_intr_stats stats;
+      int64_t start_time;
+      int i;
+
+      start_time = timer_ticks ();
+      spin_until = start_time + 4 * TIMER_FREQ;
+      for (i = 0; i < thread_cnt; i++) 
+        {
+          char name[16];
+          snprintf (name, sizeof name, "load %d", i);
+          thread_create (name, PRI_DEFAULT, load_thread, NULL);
+        }
+
+      /* Let the load settle, then sample for two seconds. */
+      timer_sleep (start_time + TIMER_FREQ - timer_ticks ());
+      timer_reset_intr_stats ();
+      timer_sleep (start_time + 3 * TIMER_FREQ - timer_ticks ());
+      timer_get_intr_stats (&stats);
+
+      for (i = 0; i < thread_cnt; i++)
+        sema_down (&done);
+
+      msg ("%d threads: %lld cycles/tick avg, %llu max; "
+           "%lld cycles/recompute avg, %llu max",
+           thread_cnt,
+           stats.count ? (long long) (stats.total_cycles / stats.count) : 0,
+           stats.max_cycles,
+           stats.recalc_count
+             ? (long long) (stats.recalc_total_cycles / stats.recalc_count) : 0,
+           stats.recalc_max_cycles);
+    }
+}
+
+static void
+load_thread (void *aux UNUSED) 
+{
+  while (timer_ticks () < spin_until)
+    continue;
+  sema_up (&done);
+}
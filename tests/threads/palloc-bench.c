@@ -0,0 +1,110 @@
+/* Measures page allocator throughput with the user pool 10%,
+   50% and 90% full.
+
+   At each level, fills the pool with single pages, then times
+   ITER_CNT rounds of allocating BATCH_CNT blocks of 1, 2, 4 and 8
+   pages and freeing them again.  Afterward, every page must be
+   back in the pool, merged into blocks at least as large as any
+   that was free before. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "intrinsic.h"
+
+#define ITER_CNT 200
+#define BATCH_CNT 16
+
+/* Largest block the test expects to get back at the end. */
+#define BIG_CNT 512
+
+static void **fill (size_t page_cnt);
+static void drain (void **);
+static uint64_t run_batches (void);
+
+void
+test_palloc_bench (void) 
+{
+  static const int levels[] = {10, 50, 90};
+  struct palloc_stats before, after;
+  void *big;
+  size_t i;
+
+  palloc_get_stats (PAL_USER, &before);
+  big = palloc_get_multiple (PAL_USER, BIG_CNT);
+  if (big == NULL)
+    fail ("no free %d-page block in the user pool.", BIG_CNT);
+  palloc_free_multiple (big, BIG_CNT);
+
+  for (i = 0; i < sizeof levels / sizeof *levels; i++) 
+    {
+      size_t used = before.page_cnt - before.free_cnt;
+      size_t want = before.page_cnt * levels[i] / 100;
+      void **chain = fill (want > used ? want - used : 0);
+
+      msg ("%d%% full: %llu cycles per allocation and free",
+           levels[i], (unsigned long long) run_batches ());
+      drain (chain);
+    }
+
+  palloc_get_stats (PAL_USER, &after);
+  if (after.free_cnt != before.free_cnt)
+    fail ("%zu pages free before, %zu after.",
+          before.free_cnt, after.free_cnt);
+  msg ("All pages returned.");
+
+  big = palloc_get_multiple (PAL_USER, BIG_CNT);
+  if (big == NULL)
+    fail ("free pages did not merge back into a %d-page block.", BIG_CNT);
+  palloc_free_multiple (big, BIG_CNT);
+  msg ("Free pages merged.");
+}
+
+/* Allocates PAGE_CNT single user pages and returns them as a
+   chain, each page pointing to the next. */
+static void **
+fill (size_t page_cnt) 
+{
+  void **chain = NULL;
+
+  while (page_cnt-- > 0) 
+    {
+      void **page = palloc_get_page (PAL_USER | PAL_ASSERT);
+      *page = chain;
+      chain = page;
+    }
+  return chain;
+}
+
+/* Frees the pages in CHAIN. */
+static void
+drain (void **chain) 
+{
+  while (chain != NULL) 
+    {
+      void **next = *chain;
+      palloc_free_page (chain);
+      chain = next;
+    }
+}
+
+/* Runs the timed allocation rounds and returns the average cost
+   of one allocation and its free, in TSC cycles. */
+static uint64_t
+run_batches (void) 
+{
+  void *blocks[BATCH_CNT];
+  uint64_t start = rdtsc ();
+  int i, j;
+
+  for (i = 0; i < ITER_CNT; i++) 
+    {
+      for (j = 0; j < BATCH_CNT; j++)
+        blocks[j] = palloc_get_multiple (PAL_USER | PAL_ASSERT, 1 << (j % 4));
+      for (j = 0; j < BATCH_CNT; j++)
+        palloc_free_multiple (blocks[j], 1 << (j % 4));
+    }
+  return (rdtsc () - start) / (ITER_CNT * BATCH_CNT);
+}
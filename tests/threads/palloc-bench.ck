@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+foreach my $level (10, 50, 90) {
+    fail "Missing timing at $level% full.\n"
+      if !grep (/\) $level% full: \d+ cycles per allocation and free/,
+		@output);
+}
+fail "Pages were not all returned.\n"
+  if !grep (/All pages returned\./, @output);
+fail "Free pages did not merge.\n"
+  if !grep (/Free pages merged\./, @output);
+pass;
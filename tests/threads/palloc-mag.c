@@ -0,0 +1,49 @@
+/* Checks the page magazines in front of the page allocator.  A
+   page just freed must be the next one handed out, the magazine
+   must never hold more than a batch's worth of surplus pages
+   after a burst of allocations and frees, and every page must be
+   accounted for as free afterward. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+
+#define PAGE_CNT 100
+
+/* Most pages a magazine may hold. */
+#define MAG_MAX 32
+
+void
+test_palloc_mag (void) 
+{
+  struct palloc_stats before, after;
+  void *pages[PAGE_CNT];
+  void *page;
+  int i;
+
+  ASSERT (!palloc_check);
+
+  page = palloc_get_page (PAL_ASSERT);
+  palloc_free_page (page);
+  if (palloc_get_page (PAL_ASSERT) != page)
+    fail ("freed page was not reused first.");
+  palloc_free_page (page);
+  msg ("Freed page reused first.");
+
+  palloc_get_stats (0, &before);
+  for (i = 0; i < PAGE_CNT; i++)
+    pages[i] = palloc_get_page (PAL_ASSERT);
+  for (i = 0; i < PAGE_CNT; i++)
+    palloc_free_page (pages[i]);
+  palloc_get_stats (0, &after);
+
+  if (after.mag_cnt > MAG_MAX)
+    fail ("magazine holds %zu pages.", after.mag_cnt);
+  msg ("Magazine drained on overflow.");
+
+  if (after.free_cnt != before.free_cnt)
+    fail ("%zu pages free before, %zu after.",
+          before.free_cnt, after.free_cnt);
+  msg ("All pages returned.");
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-mag) begin
+(palloc-mag) Freed page reused first.
+(palloc-mag) Magazine drained on overflow.
+(palloc-mag) All pages returned.
+(palloc-mag) end
+EOF
+pass;
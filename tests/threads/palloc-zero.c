@@ -0,0 +1,55 @@
+/* Checks the pool of pre-zeroed pages.  While the main thread
+   sleeps, the idle thread must zero some pages ahead of time,
+   and PAL_ZERO requests must then be served from them, with
+   every byte zero.  Multi-page PAL_ZERO requests, which the
+   pool never serves, must not count as misses. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+
+#define PAGE_CNT 8
+
+void
+test_palloc_zero (void) 
+{
+  struct palloc_stats before, after;
+  uint64_t *pages[PAGE_CNT];
+  void *block;
+  size_t i, j;
+
+  timer_sleep (10);
+  palloc_get_stats (0, &before);
+  if (before.zero_cnt < PAGE_CNT)
+    fail ("only %zu pages pre-zeroed.", before.zero_cnt);
+  msg ("Idle thread pre-zeroed pages.");
+
+  for (i = 0; i < PAGE_CNT; i++) 
+    {
+      pages[i] = palloc_get_page (PAL_ZERO | PAL_ASSERT);
+      for (j = 0; j < PGSIZE / sizeof *pages[i]; j++)
+        if (pages[i][j] != 0)
+          fail ("page %p is not zeroed at offset %zu.",
+                pages[i], j * sizeof *pages[i]);
+    }
+  palloc_get_stats (0, &after);
+  for (i = 0; i < PAGE_CNT; i++)
+    palloc_free_page (pages[i]);
+
+  if (after.zero_hits - before.zero_hits != PAGE_CNT)
+    fail ("%llu of %d PAL_ZERO requests pre-zeroed.",
+          after.zero_hits - before.zero_hits, PAGE_CNT);
+  msg ("PAL_ZERO requests served from pre-zeroed pages.");
+
+  palloc_get_stats (0, &before);
+  block = palloc_get_multiple (PAL_ZERO | PAL_ASSERT, 2);
+  palloc_get_stats (0, &after);
+  palloc_free_multiple (block, 2);
+  if (after.zero_hits != before.zero_hits
+      || after.zero_misses != before.zero_misses)
+    fail ("multi-page PAL_ZERO request counted as a hit or miss.");
+  msg ("Multi-page PAL_ZERO requests left out of the hit rate.");
+}
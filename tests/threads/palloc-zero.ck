@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(palloc-zero) begin
+(palloc-zero) Idle thread pre-zeroed pages.
+(palloc-zero) PAL_ZERO requests served from pre-zeroed pages.
+(palloc-zero) Multi-page PAL_ZERO requests left out of the hit rate.
+(palloc-zero) end
+EOF
+pass;
@@ -0,0 +1,57 @@
+/* Checks the sampling profiler, which must be enabled with
+   -profile=1.  A thread that spins for SPIN_TICKS while the main
+   thread sleeps must receive most of the samples taken in that
+   time. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/profile.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+/* How long the spinning thread runs, in timer ticks. */
+#define SPIN_TICKS 20
+
+static thread_func spinner;
+
+void
+test_profile (void) 
+{
+  struct semaphore done;
+  uint64_t total, spun, main_cnt;
+  tid_t tid;
+
+  ASSERT (profile_enabled);
+
+  sema_init (&done, 0);
+  total = profile_samples (TID_ERROR);
+  main_cnt = profile_samples (thread_tid ());
+  tid = thread_create ("spinner", PRI_DEFAULT, spinner, &done);
+  sema_down (&done);
+  total = profile_samples (TID_ERROR) - total;
+  main_cnt = profile_samples (thread_tid ()) - main_cnt;
+  spun = profile_samples (tid);
+
+  if (total < SPIN_TICKS / 2)
+    fail ("only %llu samples in %d ticks.",
+          (unsigned long long) total, SPIN_TICKS);
+  msg ("Sampled every tick.");
+
+  if (spun < SPIN_TICKS / 2 || spun <= main_cnt)
+    fail ("spinner got %llu samples, main thread %llu.",
+          (unsigned long long) spun, (unsigned long long) main_cnt);
+  msg ("Samples attributed to the spinning thread.");
+}
+
+static void
+spinner (void *done_) 
+{
+  struct semaphore *done = done_;
+  int64_t start = timer_ticks ();
+
+  while (timer_elapsed (start) < SPIN_TICKS)
+    barrier ();
+  sema_up (done);
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(profile) begin
+(profile) Sampled every tick.
+(profile) Samples attributed to the spinning thread.
+(profile) end
+EOF
+pass;
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+
+my (@output) = read_text_file ("$test.output");
+common_checks ("run", @output);
+@output = get_core_output ("run", @output);
+
+foreach my $kind ('lock', 'rwlock') {
+    fail "Missing $kind timing.\n"
+      if !grep (/\) $kind: \d+ reads in \d+ ticks, \d+ cycles uncontended/,
+		@output);
+}
+fail "Readers did not overlap under the reader-writer lock.\n"
+  if !grep (/Readers overlapped under the reader-writer lock\./, @output);
+pass;
@@ -0,0 +1,52 @@
+/* Checks that a thread holding a reader-writer lock for reading
+   can acquire it for reading again while a writer waits.
+
+   The main thread holds the lock for reading.  Writer W, at a
+   higher priority, queues up and waits for it to leave.  The
+   main thread then acquires the lock for reading a second time.
+   Waiting behind W would deadlock, since W waits for the main
+   thread, so it must get the lock at once.  W writes only once
+   both read locks are released. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func writer_func;
+
+void
+test_rwlock_nest (void) 
+{
+  struct rwlock rw;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rw);
+  rwlock_read_acquire (&rw);
+  msg ("Main acquired read lock.");
+  thread_create ("writer", PRI_DEFAULT + 1, writer_func, &rw);
+  rwlock_read_acquire (&rw);
+  msg ("Main acquired read lock again.");
+  rwlock_read_release (&rw);
+  msg ("Main released inner read lock.");
+  msg ("Main releasing outer read lock.");
+  rwlock_read_release (&rw);
+  msg ("Main finished.");
+}
+
+static void
+writer_func (void *rw_) 
+{
+  struct rwlock *rw = rw_;
+
+  rwlock_write_acquire (rw);
+  msg ("Writer acquired write lock.");
+  rwlock_write_release (rw);
+  msg ("Writer finished.");
+}
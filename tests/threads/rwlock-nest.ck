@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock-nest) begin
+(rwlock-nest) Main acquired read lock.
+(rwlock-nest) Main acquired read lock again.
+(rwlock-nest) Main released inner read lock.
+(rwlock-nest) Main releasing outer read lock.
+(rwlock-nest) Writer acquired write lock.
+(rwlock-nest) Writer finished.
+(rwlock-nest) Main finished.
+(rwlock-nest) end
+EOF
+pass;
@@ -0,0 +1,76 @@
+/* Checks that readers share a reader-writer lock, that a waiting
+   writer keeps new readers out, and that readers waiting on the
+   writer donate their priority to it.
+
+   The main thread holds the lock for reading.  Reader A, at a
+   higher priority, gets it for reading too.  Writer W, higher
+   still, waits for the main thread to leave, and reader B, the
+   highest, then waits behind W even though only a reader holds
+   the lock, donating its priority to W.  When the main thread
+   releases the lock, W writes at B's priority, then B reads. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func reader_a_func;
+static thread_func writer_func;
+static thread_func reader_b_func;
+
+void
+test_rwlock (void) 
+{
+  struct rwlock rw;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&rw);
+  rwlock_read_acquire (&rw);
+  msg ("Main acquired read lock.");
+  thread_create ("reader-a", PRI_DEFAULT + 1, reader_a_func, &rw);
+  thread_create ("writer", PRI_DEFAULT + 2, writer_func, &rw);
+  thread_create ("reader-b", PRI_DEFAULT + 3, reader_b_func, &rw);
+  msg ("Main releasing read lock.");
+  rwlock_read_release (&rw);
+  msg ("Main finished.");
+}
+
+static void
+reader_a_func (void *rw_) 
+{
+  struct rwlock *rw = rw_;
+
+  rwlock_read_acquire (rw);
+  msg ("Reader A acquired read lock.");
+  rwlock_read_release (rw);
+  msg ("Reader A finished.");
+}
+
+static void
+writer_func (void *rw_) 
+{
+  struct rwlock *rw = rw_;
+
+  rwlock_write_acquire (rw);
+  msg ("Writer acquired write lock with priority %d.",
+       thread_get_priority ());
+  rwlock_write_release (rw);
+  msg ("Writer finished.");
+}
+
+static void
+reader_b_func (void *rw_) 
+{
+  struct rwlock *rw = rw_;
+
+  rwlock_read_acquire (rw);
+  msg ("Reader B acquired read lock.");
+  rwlock_read_release (rw);
+  msg ("Reader B finished.");
+}
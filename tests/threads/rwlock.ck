@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock) begin
+(rwlock) Main acquired read lock.
+(rwlock) Reader A acquired read lock.
+(rwlock) Reader A finished.
+(rwlock) Main releasing read lock.
+(rwlock) Writer acquired write lock with priority 34.
+(rwlock) Reader B acquired read lock.
+(rwlock) Reader B finished.
+(rwlock) Writer finished.
+(rwlock) Main finished.
+(rwlock) end
+EOF
+pass;
@@ -0,0 +1,55 @@
+/* Checks the strict ordering between scheduling classes: a
+   SCHED_FIFO thread runs ahead of any SCHED_NORMAL thread, no
+   matter their priorities, and a SCHED_IDLE thread runs only
+   when no other thread is ready. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+static thread_func rt_thread;
+static thread_func background_thread;
+
+static struct semaphore rt_wake;
+static struct semaphore idle_done;
+
+void
+test_sched_class (void) 
+{
+  sema_init (&rt_wake, 0);
+  sema_init (&idle_done, 0);
+
+  thread_create ("rt", PRI_DEFAULT, rt_thread, NULL);
+  msg ("Created a normal thread that will switch itself to SCHED_FIFO.");
+  thread_yield ();
+
+  thread_create ("idle", PRI_MAX, background_thread, NULL);
+  msg ("Created a priority %d thread that will switch itself to "
+       "SCHED_IDLE.", PRI_MAX);
+
+  msg ("Waking rt, which must preempt main.");
+  sema_up (&rt_wake);
+  msg ("main: rt has finished.");
+
+  sema_down (&idle_done);
+  msg ("main: woke up.");
+}
+
+static void
+rt_thread (void *aux UNUSED) 
+{
+  ASSERT (thread_set_sched (thread_current (), SCHED_FIFO, PRI_MIN));
+  msg ("rt: switched to SCHED_FIFO at priority %d.", PRI_MIN);
+  sema_down (&rt_wake);
+  msg ("rt: woke up ahead of main.");
+}
+
+static void
+background_thread (void *aux UNUSED) 
+{
+  ASSERT (thread_set_sched (thread_current (), SCHED_IDLE, PRI_DEFAULT));
+  msg ("idle: running only because main blocked.");
+  sema_up (&idle_done);
+}
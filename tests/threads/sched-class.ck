@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(sched-class) begin
+(sched-class) Created a normal thread that will switch itself to SCHED_FIFO.
+(sched-class) rt: switched to SCHED_FIFO at priority 0.
+(sched-class) Created a priority 63 thread that will switch itself to SCHED_IDLE.
+(sched-class) Waking rt, which must preempt main.
+(sched-class) rt: woke up ahead of main.
+(sched-class) main: rt has finished.
+(sched-class) idle: running only because main blocked.
+(sched-class) main: woke up.
+(sched-class) end
+EOF
+pass;
@@ -0,0 +1,151 @@
+/* Compares scheduling latency between the MLFQS and CFS modes
+   under the same workload.
+
+   Each round starts HOG_CNT threads that spin for a few seconds.
+   Meanwhile an interactive thread repeatedly sleeps for a couple
+   of ticks and records how late it got back onto the CPU, and
+   the main thread launches a stream of short-lived jobs, in the
+   manner of fork-multiple or multi-recurse, and records how long
+   each took from creation to completion.  The median, 99th
+   percentile and maximum of both are printed, in timer ticks.
+
+   The same code runs as mlfqs-latency under -mlfqs and as
+   cfs-latency under -sched=cfs, so the two outputs can be
+   compared directly.  The numbers depend on the machine, so the
+   tests only check that every round reports. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+static const int hog_cnts[] = {0, 4, 16};
+
+#define SAMPLE_CNT 100          /* Interactive thread wakeups. */
+#define SLEEP_TICKS 2           /* Interactive sleep length. */
+#define JOB_CNT 50              /* Short-lived jobs per round. */
+#define JOB_INTERVAL 2          /* Ticks between job launches. */
+#define JOB_LOOPS 200000        /* Work done by each job. */
+
+static int64_t spin_until;
+static struct semaphore done;
+
+static int64_t wakeup_latency[SAMPLE_CNT];
+static int64_t turnaround[JOB_CNT];
+static int64_t job_start[JOB_CNT];
+
+static void run_latency (void);
+static void hog_thread (void *aux);
+static void interactive_thread (void *aux);
+static void job_thread (void *aux);
+static void sort (int64_t *, size_t cnt);
+
+void
+test_mlfqs_latency (void) 
+{
+  ASSERT (thread_mlfqs);
+  run_latency ();
+}
+
+void
+test_cfs_latency (void) 
+{
+  ASSERT (thread_cfs);
+  run_latency ();
+}
+
+static void
+run_latency (void) 
+{
+  size_t round;
+
+  sema_init (&done, 0);
+  for (round = 0; round < sizeof hog_cnts / sizeof *hog_cnts; round++)
+    {
+      int hog_cnt = hog_cnts[round];
+      char name[16];
+      int i;
+
+      spin_until = timer_ticks () + 4 * TIMER_FREQ;
+      for (i = 0; i < hog_cnt; i++) 
+        {
+          snprintf (name, sizeof name, "hog %d", i);
+          thread_create (name, PRI_DEFAULT, hog_thread, NULL);
+        }
+      thread_create ("interactive", PRI_DEFAULT, interactive_thread, NULL);
+
+      for (i = 0; i < JOB_CNT; i++) 
+        {
+          snprintf (name, sizeof name, "job %d", i);
+          job_start[i] = timer_ticks ();
+          thread_create (name, PRI_DEFAULT, job_thread, &job_start[i]);
+          timer_sleep (JOB_INTERVAL);
+        }
+
+      for (i = 0; i < hog_cnt + 1 + JOB_CNT; i++)
+        sema_down (&done);
+
+      sort (wakeup_latency, SAMPLE_CNT);
+      sort (turnaround, JOB_CNT);
+      msg ("%d hogs: wakeup latency p50 %lld p99 %lld max %lld ticks; "
+           "turnaround p50 %lld p99 %lld max %lld ticks",
+           hog_cnt,
+           (long long) wakeup_latency[SAMPLE_CNT / 2],
+           (long long) wakeup_latency[(SAMPLE_CNT - 1) * 99 / 100],
+           (long long) wakeup_latency[SAMPLE_CNT - 1],
+           (long long) turnaround[JOB_CNT / 2],
+           (long long) turnaround[(JOB_CNT - 1) * 99 / 100],
+           (long long) turnaround[JOB_CNT - 1]);
+    }
+}
+
+static void
+hog_thread (void *aux UNUSED) 
+{
+  while (timer_ticks () < spin_until)
+    continue;
+  sema_up (&done);
+}
+
+static void
+interactive_thread (void *aux UNUSED) 
+{
+  int i;
+
+  for (i = 0; i < SAMPLE_CNT; i++) 
+    {
+      int64_t wakeup = timer_ticks () + SLEEP_TICKS;
+      timer_sleep (SLEEP_TICKS);
+      wakeup_latency[i] = timer_ticks () - wakeup;
+    }
+  sema_up (&done);
+}
+
+static void
+job_thread (void *start_) 
+{
+  int64_t *start = start_;
+  volatile int i;
+
+  for (i = 0; i < JOB_LOOPS; i++)
+    continue;
+  turnaround[start - job_start] = timer_ticks () - *start;
+  sema_up (&done);
+}
+
+/* Sorts the CNT values in A into ascending order. */
+static void
+sort (int64_t *a, size_t cnt) 
+{
+  size_t i, j;
+
+  for (i = 1; i < cnt; i++) 
+    {
+      int64_t v = a[i];
+      for (j = i; j > 0 && a[j - 1] > v; j--)
+        a[j] = a[j - 1];
+      a[j] = v;
+    }
+}
@@ -0,0 +1,108 @@
+/* Checks that sequence lock readers retry after a write and
+   never see a half-written record.
+
+   First, the main thread starts a read, lets a writer thread
+   update the record, and checks that the read must be retried.
+   Then a timer callback rewrites the record on every tick, in an
+   interrupt handler, while the main thread reads it in a loop
+   that leaves plenty of room for the timer to get in the way. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define TICK_CNT 10
+
+struct record 
+  {
+    int64_t lo;
+    int64_t hi;
+  };
+
+static struct seqlock sl;
+static struct record rec;
+static struct semaphore go;
+static struct timer_event writer_event;
+static volatile bool writing;
+
+static thread_func writer_thread;
+static void writer_tick (void *aux);
+static void update_record (void);
+
+void
+test_seqlock (void) 
+{
+  struct record copy;
+  unsigned seq;
+  int64_t end;
+
+  seqlock_init (&sl);
+  sema_init (&go, 0);
+
+  seq = seqlock_read_begin (&sl);
+  copy = rec;
+  if (seqlock_read_retry (&sl, seq))
+    fail ("read retried with no writer.");
+
+  seq = seqlock_read_begin (&sl);
+  copy = rec;
+  thread_create ("writer", PRI_DEFAULT + 1, writer_thread, NULL);
+  sema_up (&go);
+  if (!seqlock_read_retry (&sl, seq))
+    fail ("read did not retry after a write.");
+  msg ("Reader retried after a write.");
+
+  writing = true;
+  timer_event_init (&writer_event, writer_tick, NULL);
+  timer_add (&writer_event, timer_ticks () + 1);
+  end = timer_ticks () + TICK_CNT;
+  while (timer_ticks () < end) 
+    {
+      int i;
+
+      do 
+        {
+          seq = seqlock_read_begin (&sl);
+          copy.lo = rec.lo;
+          for (i = 0; i < 1000; i++)
+            barrier ();
+          copy.hi = rec.hi;
+        }
+      while (seqlock_read_retry (&sl, seq));
+      if (copy.lo != copy.hi)
+        fail ("read half-written record: lo=%lld, hi=%lld.",
+              (long long) copy.lo, (long long) copy.hi);
+    }
+  writing = false;
+  timer_cancel (&writer_event);
+  msg ("All reads were consistent.");
+}
+
+static void
+writer_thread (void *aux UNUSED) 
+{
+  sema_down (&go);
+  update_record ();
+}
+
+static void
+writer_tick (void *aux UNUSED) 
+{
+  update_record ();
+  if (writing)
+    timer_add (&writer_event, timer_ticks () + 1);
+}
+
+static void
+update_record (void) 
+{
+  enum intr_level old_level = seqlock_write_begin (&sl);
+
+  rec.lo++;
+  barrier ();
+  rec.hi = rec.lo;
+  seqlock_write_end (&sl, old_level);
+}
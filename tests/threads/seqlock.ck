@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(seqlock) begin
+(seqlock) Reader retried after a write.
+(seqlock) All reads were consistent.
+(seqlock) end
+EOF
+pass;
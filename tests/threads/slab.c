@@ -0,0 +1,78 @@
+/* Checks the slab allocator.  Objects from a cache must be
+   aligned as requested and constructed once, keep their
+   constructed state across a free and reallocation, and be laid
+   out at different colour offsets in different slabs. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/slab.h"
+#include "threads/vaddr.h"
+
+/* Object size and alignment.  With 4 kB pages, a slab holds 15
+   objects and has room for 3 colours. */
+#define OBJ_SIZE 200
+#define OBJ_ALIGN 64
+
+/* Enough objects to fill several slabs. */
+#define OBJ_CNT 60
+
+#define OBJ_MAGIC 0x0b1ec7
+
+static int ctor_cnt;
+
+static void
+ctor (void *obj) 
+{
+  *(int *) obj = OBJ_MAGIC;
+  ctor_cnt++;
+}
+
+void
+test_slab (void) 
+{
+  struct kmem_cache *cache;
+  void *objs[OBJ_CNT];
+  void *obj;
+  size_t first_ofs = 0;
+  bool coloured = false;
+  int i, cnt;
+
+  cache = kmem_cache_create ("test", OBJ_SIZE, OBJ_ALIGN, ctor);
+  ASSERT (cache != NULL);
+
+  for (i = 0; i < OBJ_CNT; i++) 
+    {
+      objs[i] = kmem_cache_alloc (cache);
+      if (objs[i] == NULL)
+        fail ("allocation %d failed.", i);
+      if ((uintptr_t) objs[i] % OBJ_ALIGN != 0)
+        fail ("object %p is not %d-byte aligned.", objs[i], OBJ_ALIGN);
+      if (*(int *) objs[i] != OBJ_MAGIC)
+        fail ("object %p was not constructed.", objs[i]);
+    }
+  msg ("Objects aligned and constructed.");
+
+  /* Each slab hands out its lowest address first, so an object
+     that starts a new page is its slab's first. */
+  for (i = 0; i < OBJ_CNT; i++)
+    if (i == 0 || pg_round_down (objs[i]) != pg_round_down (objs[i - 1])) 
+      {
+        if (i != 0 && pg_ofs (objs[i]) != first_ofs)
+          coloured = true;
+        first_ofs = pg_ofs (objs[i]);
+      }
+  if (!coloured)
+    fail ("every slab starts at offset %zu.", first_ofs);
+  msg ("Slabs coloured.");
+
+  cnt = ctor_cnt;
+  kmem_cache_free (cache, objs[0]);
+  obj = kmem_cache_alloc (cache);
+  if (obj != objs[0] || *(int *) obj != OBJ_MAGIC || ctor_cnt != cnt)
+    fail ("freed object was not reused in its constructed state.");
+  msg ("Freed object reused without reconstruction.");
+
+  for (i = 0; i < OBJ_CNT; i++)
+    kmem_cache_free (cache, objs[i]);
+}
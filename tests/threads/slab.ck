@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(slab) begin
+(slab) Objects aligned and constructed.
+(slab) Slabs coloured.
+(slab) Freed object reused without reconstruction.
+(slab) end
+EOF
+pass;
@@ -29,6 +29,33 @@ static const struct test tests[] =
     {"priority-preempt", test_priority_preempt},
     {"priority-sema", test_priority_sema},
     {"priority-condvar", test_priority_condvar},
+    {"sched-class", test_sched_class},
+    {"edf-admit", test_edf_admit},
+    {"edf-mixed", test_edf_mixed},
+    {"ctx-switch", test_ctx_switch},
+    {"ctx-switch-iret", test_ctx_switch_iret},
+    {"kstack-deep", test_kstack_deep},
+    {"thread-create", test_thread_create},
+    {"thread-create-nocache", test_thread_create_nocache},
+    {"lock-stress", test_lock_stress},
+    {"rwlock", test_rwlock},
+    {"rwlock-nest", test_rwlock_nest},
+    {"seqlock", test_seqlock},
+    {"rwlock-bench", test_rwlock_bench},
+    {"timeout-sema", test_timeout_sema},
+    {"timeout-lock", test_timeout_lock},
+    {"timeout-steal", test_timeout_steal},
+    {"workqueue", test_workqueue},
+    {"irqsoff", test_irqsoff},
+    {"timer-ns", test_timer_ns},
+    {"hrtimer", test_hrtimer},
+    {"hrtimer-pit", test_hrtimer_pit},
+    {"profile", test_profile},
+    {"palloc-bench", test_palloc_bench},
+    {"palloc-mag", test_palloc_mag},
+    {"slab", test_slab},
+    {"malloc-realloc", test_malloc_realloc},
+    {"palloc-zero", test_palloc_zero},
     {"mlfqs-load-1", test_mlfqs_load_1},
     {"mlfqs-load-60", test_mlfqs_load_60},
     {"mlfqs-load-avg", test_mlfqs_load_avg},
@@ -38,6 +65,11 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"mlfqs-intr-bench", test_mlfqs_intr_bench},
+    {"mlfqs-latency", test_mlfqs_latency},
+    {"cfs-fair-2", test_cfs_fair_2},
+    {"cfs-nice-2", test_cfs_nice_2},
+    {"cfs-latency", test_cfs_latency},
   };
 
 static const char *test_name;
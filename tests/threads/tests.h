@@ -23,6 +23,33 @@ extern test_func test_priority_fifo;
 extern test_func test_priority_preempt;
 extern test_func test_priority_sema;
 extern test_func test_priority_condvar;
+extern test_func test_sched_class;
+extern test_func test_edf_admit;
+extern test_func test_edf_mixed;
+extern test_func test_ctx_switch;
+extern test_func test_ctx_switch_iret;
+extern test_func test_kstack_deep;
+extern test_func test_thread_create;
+extern test_func test_thread_create_nocache;
+extern test_func test_lock_stress;
+extern test_func test_rwlock;
+extern test_func test_rwlock_nest;
+extern test_func test_seqlock;
+extern test_func test_rwlock_bench;
+extern test_func test_timeout_sema;
+extern test_func test_timeout_lock;
+extern test_func test_timeout_steal;
+extern test_func test_workqueue;
+extern test_func test_irqsoff;
+extern test_func test_timer_ns;
+extern test_func test_hrtimer;
+extern test_func test_hrtimer_pit;
+extern test_func test_profile;
+extern test_func test_palloc_bench;
+extern test_func test_palloc_mag;
+extern test_func test_slab;
+extern test_func test_malloc_realloc;
+extern test_func test_palloc_zero;
 extern test_func test_mlfqs_load_1;
 extern test_func test_mlfqs_load_60;
 extern test_func test_mlfqs_load_avg;
@@ -32,6 +59,11 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_mlfqs_intr_bench;
+extern test_func test_mlfqs_latency;
+extern test_func test_cfs_fair_2;
+extern test_func test_cfs_nice_2;
+extern test_func test_cfs_latency;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
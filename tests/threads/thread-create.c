@@ -0,0 +1,63 @@
+/* Measures the cost of creating a thread and letting it exit.
+
+   Each round creates ITER_CNT threads, one at a time, at a
+   higher priority than the main thread, so that each runs and
+   exits before thread_create() returns, and times the rounds
+   with the TSC.  Dead threads' stacks are reclaimed at the next
+   thread switch, so from the third thread on, every creation can
+   reuse a cached stack.
+
+   thread-create uses the thread stack cache, the default, and
+   thread-create-nocache runs the same code under -tcache=0,
+   which allocates every stack from the page allocator.  The
+   numbers depend on the machine, so the tests only check that
+   every round reports. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "intrinsic.h"
+
+#define ROUND_CNT 3
+#define ITER_CNT 1000
+
+static void run_thread_create (void);
+static void exit_thread (void *aux);
+
+void
+test_thread_create (void) 
+{
+  ASSERT (thread_cache_max > 0);
+  run_thread_create ();
+}
+
+void
+test_thread_create_nocache (void) 
+{
+  ASSERT (thread_cache_max == 0);
+  run_thread_create ();
+}
+
+static void
+run_thread_create (void) 
+{
+  int round, i;
+
+  for (round = 0; round < ROUND_CNT; round++) 
+    {
+      uint64_t start = rdtsc ();
+
+      for (i = 0; i < ITER_CNT; i++)
+        if (thread_create ("child", PRI_DEFAULT + 1, exit_thread, NULL)
+            == TID_ERROR)
+          fail ("thread_create failed");
+      msg ("round %d: %llu cycles/thread", round,
+           (unsigned long long) (rdtsc () - start) / ITER_CNT);
+    }
+}
+
+static void
+exit_thread (void *aux UNUSED) 
+{
+}
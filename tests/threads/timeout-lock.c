@@ -0,0 +1,81 @@
+/* Checks lock_acquire_timeout() and cond_wait_timeout().
+
+   The main thread holds a lock that a high-priority thread waits
+   for with a timeout.  While it waits, it donates its priority to
+   the main thread, and once it gives up, the main thread must
+   drop back to its own priority.
+
+   Then the main thread waits on a condition variable, first with
+   nobody to signal it, which must time out with the lock held
+   again, and then with a thread that signals it. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+struct lock_and_cond 
+  {
+    struct lock lock;
+    struct condition cond;
+  };
+
+static thread_func waiter_thread;
+static thread_func signaler_thread;
+
+void
+test_timeout_lock (void) 
+{
+  struct lock_and_cond lc;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  lock_init (&lc.lock);
+  cond_init (&lc.cond);
+
+  lock_acquire (&lc.lock);
+  thread_create ("waiter", PRI_DEFAULT + 10, waiter_thread, &lc);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT + 10, thread_get_priority ());
+  timer_sleep (10);
+  msg ("Main thread should have priority %d.  Actual priority: %d.",
+       PRI_DEFAULT, thread_get_priority ());
+
+  if (cond_wait_timeout (&lc.cond, &lc.lock, 3))
+    fail ("condition signaled with nobody to signal it.");
+  if (!lock_held_by_current_thread (&lc.lock))
+    fail ("lock not held after timed-out condition wait.");
+  msg ("Condition wait timed out.");
+
+  thread_create ("signaler", PRI_DEFAULT + 1, signaler_thread, &lc);
+  if (!cond_wait_timeout (&lc.cond, &lc.lock, 100))
+    fail ("condition wait timed out although signaled.");
+  msg ("Condition signaled before the timeout.");
+  lock_release (&lc.lock);
+}
+
+static void
+waiter_thread (void *lc_) 
+{
+  struct lock_and_cond *lc = lc_;
+
+  if (lock_acquire_timeout (&lc->lock, 5))
+    fail ("acquired a lock the main thread holds.");
+  msg ("Waiter gave up on the lock.");
+}
+
+static void
+signaler_thread (void *lc_) 
+{
+  struct lock_and_cond *lc = lc_;
+
+  lock_acquire (&lc->lock);
+  cond_signal (&lc->cond, &lc->lock);
+  lock_release (&lc->lock);
+}
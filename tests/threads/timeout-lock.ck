@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(timeout-lock) begin
+(timeout-lock) Main thread should have priority 41.  Actual priority: 41.
+(timeout-lock) Waiter gave up on the lock.
+(timeout-lock) Main thread should have priority 31.  Actual priority: 31.
+(timeout-lock) Condition wait timed out.
+(timeout-lock) Condition signaled before the timeout.
+(timeout-lock) end
+EOF
+pass;
@@ -0,0 +1,69 @@
+/* Checks sema_down_timeout().  A wait with nobody to up the
+   semaphore must time out after the full timeout, a wait that a
+   sema_up() ends early must succeed early, and when the sema_up()
+   and the timeout land on the same tick, whichever wins, the
+   semaphore's value must account for the up exactly once. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+struct upper 
+  {
+    struct semaphore *sema;
+    int64_t ticks;
+  };
+
+static thread_func upper_thread;
+
+void
+test_timeout_sema (void) 
+{
+  struct semaphore sema;
+  struct upper upper;
+  int64_t start;
+  bool success;
+
+  sema_init (&sema, 0);
+  upper.sema = &sema;
+
+  if (sema_down_timeout (&sema, 0))
+    fail ("zero-tick wait downed a zero semaphore.");
+
+  start = timer_ticks ();
+  if (sema_down_timeout (&sema, 5))
+    fail ("downed a semaphore nobody upped.");
+  if (timer_elapsed (start) < 5)
+    fail ("timed out after %lld ticks, expected at least 5.",
+          (long long) timer_elapsed (start));
+  msg ("Timed out after the full timeout.");
+
+  upper.ticks = 2;
+  thread_create ("upper", PRI_DEFAULT + 1, upper_thread, &upper);
+  start = timer_ticks ();
+  if (!sema_down_timeout (&sema, 100))
+    fail ("timed out although the semaphore was upped.");
+  if (timer_elapsed (start) >= 100)
+    fail ("woke up only after the timeout.");
+  msg ("Woken by sema_up before the timeout.");
+
+  upper.ticks = 3;
+  thread_create ("upper", PRI_DEFAULT + 1, upper_thread, &upper);
+  success = sema_down_timeout (&sema, 3);
+  timer_sleep (2);
+  if (sema_try_down (&sema) == success)
+    fail ("semaphore value wrong after racing timeout and sema_up.");
+  msg ("Semaphore value consistent after a race.");
+}
+
+static void
+upper_thread (void *upper_) 
+{
+  struct upper *upper = upper_;
+
+  timer_sleep (upper->ticks);
+  sema_up (upper->sema);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(timeout-sema) begin
+(timeout-sema) Timed out after the full timeout.
+(timeout-sema) Woken by sema_up before the timeout.
+(timeout-sema) Semaphore value consistent after a race.
+(timeout-sema) end
+EOF
+pass;
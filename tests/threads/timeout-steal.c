@@ -0,0 +1,95 @@
+/* Checks that a timeout is not lost when the value a timed wait
+   was woken for is stolen.
+
+   A high-priority thief ups a semaphore that the main thread is
+   waiting on with a timeout, which takes the main thread off the
+   wait queue.  The thief keeps the CPU until the timeout has
+   passed and then takes the value back, so the main thread finds
+   nothing when it finally runs.  It must report a timeout instead
+   of waiting again with no timer left to wake it.
+
+   The same is then done with a lock: the thief releases the lock
+   and acquires it again, the common way a waiter loses a lock. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define TIMEOUT 5
+
+struct steal 
+  {
+    struct semaphore sema;      /* Semaphore the main thread waits on. */
+    struct lock lock;           /* Lock the main thread waits on. */
+    struct semaphore done;      /* Upped once the main thread reports. */
+    int64_t deadline;           /* Tick the main thread's wait ends. */
+  };
+
+static thread_func sema_thief;
+static thread_func lock_thief;
+static void spin_past (int64_t deadline);
+
+void
+test_timeout_steal (void) 
+{
+  struct steal s;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&s.sema, 0);
+  lock_init (&s.lock);
+  sema_init (&s.done, 0);
+
+  thread_create ("sema-thief", PRI_DEFAULT + 1, sema_thief, &s);
+  s.deadline = timer_ticks () + TIMEOUT;
+  if (sema_down_timeout (&s.sema, TIMEOUT))
+    fail ("downed a semaphore whose value was stolen.");
+  msg ("Semaphore wait timed out after its value was stolen.");
+
+  thread_create ("lock-thief", PRI_DEFAULT + 1, lock_thief, &s);
+  s.deadline = timer_ticks () + TIMEOUT;
+  if (lock_acquire_timeout (&s.lock, TIMEOUT))
+    fail ("acquired a lock that was taken back.");
+  msg ("Lock wait timed out after the lock was taken back.");
+  sema_up (&s.done);
+}
+
+static void
+sema_thief (void *s_) 
+{
+  struct steal *s = s_;
+
+  while (waitq_empty (&s->sema.waiters))
+    timer_sleep (1);
+  sema_up (&s->sema);
+  spin_past (s->deadline);
+  sema_down (&s->sema);
+}
+
+static void
+lock_thief (void *s_) 
+{
+  struct steal *s = s_;
+
+  lock_acquire (&s->lock);
+  while (waitq_empty (&s->lock.semaphore.waiters))
+    timer_sleep (1);
+  lock_release (&s->lock);
+  spin_past (s->deadline);
+  lock_acquire (&s->lock);
+  sema_down (&s->done);
+  lock_release (&s->lock);
+}
+
+/* Keeps the CPU until the timer has passed DEADLINE, with a
+   couple of ticks to spare for a wait that started a tick late. */
+static void
+spin_past (int64_t deadline) 
+{
+  while (timer_ticks () <= deadline + 2)
+    barrier ();
+}
@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(timeout-steal) begin
+(timeout-steal) Semaphore wait timed out after its value was stolen.
+(timeout-steal) Lock wait timed out after the lock was taken back.
+(timeout-steal) end
+EOF
+pass;
@@ -0,0 +1,65 @@
+/* Checks the TSC clocksource.  timer_now_ns() must never go
+   backward and must agree with timer_ticks(), sub-tick sleeps
+   must last at least as long as asked, and a thread's CPU time
+   must grow while it runs but not while it sleeps. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define NS_PER_TICK (1000000000 / TIMER_FREQ)
+
+void
+test_timer_ns (void) 
+{
+  int64_t start_ticks, start_ns, prev, now, cpu;
+  int i;
+
+  start_ticks = timer_ticks ();
+  start_ns = timer_now_ns ();
+  prev = start_ns;
+  for (i = 0; i < 100000; i++) 
+    {
+      now = timer_now_ns ();
+      if (now < prev)
+        fail ("time went backward by %lld ns.", (long long) (prev - now));
+      prev = now;
+    }
+  msg ("timer_now_ns() is monotonic.");
+
+  timer_sleep (10);
+  now = timer_now_ns ();
+  if (now - start_ns < (timer_ticks () - start_ticks - 1) * NS_PER_TICK
+      || now - start_ns > (timer_ticks () - start_ticks + 1) * NS_PER_TICK)
+    fail ("%lld ns went by in %lld ticks.", (long long) (now - start_ns),
+          (long long) (timer_ticks () - start_ticks));
+  msg ("timer_now_ns() agrees with timer_ticks().");
+
+  for (i = 0; i < 10; i++) 
+    {
+      start_ns = timer_now_ns ();
+      timer_usleep (100);
+      if (timer_now_ns () - start_ns < 100 * 1000)
+        fail ("timer_usleep (100) returned after %lld ns.",
+              (long long) (timer_now_ns () - start_ns));
+    }
+  msg ("Sub-tick sleeps last long enough.");
+
+  cpu = thread_get_cpu_ns ();
+  start_ns = timer_now_ns ();
+  while (timer_now_ns () - start_ns < 2 * NS_PER_TICK)
+    continue;
+  if (thread_get_cpu_ns () - cpu < 2 * NS_PER_TICK)
+    fail ("CPU time grew by only %lld ns while running.",
+          (long long) (thread_get_cpu_ns () - cpu));
+  msg ("CPU time grows while running.");
+
+  cpu = thread_get_cpu_ns ();
+  timer_sleep (10);
+  if (thread_get_cpu_ns () - cpu > 5 * NS_PER_TICK)
+    fail ("CPU time grew by %lld ns while sleeping.",
+          (long long) (thread_get_cpu_ns () - cpu));
+  msg ("CPU time does not grow while sleeping.");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(timer-ns) begin
+(timer-ns) timer_now_ns() is monotonic.
+(timer-ns) timer_now_ns() agrees with timer_ticks().
+(timer-ns) Sub-tick sleeps last long enough.
+(timer-ns) CPU time grows while running.
+(timer-ns) CPU time does not grow while sleeping.
+(timer-ns) end
+EOF
+pass;
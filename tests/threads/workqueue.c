@@ -0,0 +1,103 @@
+/* Checks deferred work.  Work queued on a workqueue must run in a
+   worker thread with interrupts on, whether it was queued from a
+   thread or from an interrupt handler, and softirq work raised
+   from an interrupt handler must run when the interrupt returns,
+   with interrupts on but still in interrupt context.  Queueing
+   pending work again must do nothing, and flush_work() must wait
+   for work that is still pending or running. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
+
+static struct thread *main_thread;
+static struct workqueue *high_wq, *low_wq;
+static struct work thread_work, intr_work, soft_work, low_work, slow_work;
+static struct timer_event intr_event;
+static int low_runs;
+static volatile bool slow_done;
+
+static work_func check_worker;
+static work_func check_softirq;
+static work_func count_low;
+static work_func slow_func;
+static void queue_from_intr (void *aux);
+
+void
+test_workqueue (void) 
+{
+  main_thread = thread_current ();
+  high_wq = workqueue_create ("high-wq", PRI_DEFAULT + 1, 2);
+  low_wq = workqueue_create ("low-wq", PRI_DEFAULT - 1, 1);
+  if (high_wq == NULL || low_wq == NULL)
+    fail ("workqueue_create failed.");
+
+  work_init (&thread_work, check_worker, "thread");
+  queue_work (high_wq, &thread_work);
+  flush_work (&thread_work);
+
+  work_init (&intr_work, check_worker, "interrupt");
+  work_init (&soft_work, check_softirq, NULL);
+  timer_event_init (&intr_event, queue_from_intr, NULL);
+  timer_add (&intr_event, timer_ticks () + 1);
+  timer_sleep (2);
+  flush_work (&soft_work);
+  flush_work (&intr_work);
+
+  work_init (&low_work, count_low, NULL);
+  if (!queue_work (low_wq, &low_work))
+    fail ("could not queue idle work.");
+  if (queue_work (low_wq, &low_work))
+    fail ("queued pending work again.");
+  flush_work (&low_work);
+  msg ("Pending work ran %d time(s).", low_runs);
+
+  work_init (&slow_work, slow_func, NULL);
+  queue_work (high_wq, &slow_work);
+  flush_work (&slow_work);
+  if (!slow_done)
+    fail ("flush_work returned before the work finished.");
+  msg ("flush_work waited for sleeping work to finish.");
+}
+
+static void
+queue_from_intr (void *aux UNUSED) 
+{
+  softirq_raise (&soft_work);
+  queue_work (high_wq, &intr_work);
+}
+
+static void
+check_worker (void *from) 
+{
+  if (thread_current () == main_thread)
+    fail ("work queued from %s ran in the main thread.", (char *) from);
+  if (intr_get_level () != INTR_ON || intr_context ())
+    fail ("work queued from %s ran in interrupt context.", (char *) from);
+  msg ("Work queued from %s ran in a worker.", (char *) from);
+}
+
+static void
+check_softirq (void *aux UNUSED) 
+{
+  if (!intr_context () || intr_get_level () != INTR_ON)
+    fail ("softirq work did not run at interrupt return.");
+  msg ("Softirq work ran at interrupt return with interrupts on.");
+}
+
+static void
+count_low (void *aux UNUSED) 
+{
+  low_runs++;
+}
+
+static void
+slow_func (void *aux UNUSED) 
+{
+  timer_sleep (3);
+  slow_done = true;
+}
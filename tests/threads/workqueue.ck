@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(workqueue) begin
+(workqueue) Work queued from thread ran in a worker.
+(workqueue) Softirq work ran at interrupt return with interrupts on.
+(workqueue) Work queued from interrupt ran in a worker.
+(workqueue) Pending work ran 1 time(s).
+(workqueue) flush_work waited for sleeping work to finish.
+(workqueue) end
+EOF
+pass;
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "devices/hrtimer.h"
 #include "devices/kbd.h"
 #include "devices/input.h"
 #include "devices/serial.h"
@@ -15,12 +16,19 @@
 #include "devices/vga.h"
 #include "threads/interrupt.h"
 #include "threads/io.h"
+#include "threads/irqsoff.h"
+#include "threads/lapic.h"
 #include "threads/loader.h"
+#include "threads/lockstat.h"
 #include "threads/malloc.h"
 #include "threads/mmu.h"
 #include "threads/palloc.h"
+#include "threads/profile.h"
 #include "threads/pte.h"
+#include "threads/sched.h"
+#include "threads/slab.h"
 #include "threads/thread.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -85,6 +93,7 @@ main (void) {
 	/* Initialize memory system. */
 	mem_end = palloc_init ();
 	malloc_init ();
+	kmem_init ();
 	paging_init (mem_end);
 
 #ifdef USERPROG
@@ -94,6 +103,7 @@ main (void) {
 
 	/* Initialize interrupt handlers. */
 	intr_init ();
+	workqueue_init ();
 	timer_init ();
 	kbd_init ();
 	input_init ();
@@ -105,6 +115,7 @@ main (void) {
 	thread_start ();
 	serial_init_queue ();
 	timer_calibrate ();
+	hrtimer_init ();
 
 #ifdef FILESYS
 	/* Initialize file system. */
@@ -221,6 +232,53 @@ parse_options (char **argv) {
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+		else if (!strcmp (name, "-sched")) {
+			if (value != NULL && !strcmp (value, "cfs"))
+				thread_cfs = true;
+			else if (value != NULL && !strcmp (value, "mlfqs"))
+				thread_mlfqs = true;
+			else if (value == NULL || strcmp (value, "prio"))
+				PANIC ("unknown scheduler `%s' (use -h for help)",
+						value != NULL ? value : "");
+		}
+		else if (!strcmp (name, "-kstack")) {
+			int kb;
+			if (value == NULL)
+				PANIC ("-kstack needs a size in kB (use -h for help)");
+			kb = atoi (value);
+			if (kb != 8 && kb != 16)
+				PANIC ("kernel stack must be 8 or 16 kB, not `%s'", value);
+			thread_stack_pages = kb * 1024 / PGSIZE;
+		}
+		else if (!strcmp (name, "-palloc-check"))
+			palloc_check = true;
+		else if (!strcmp (name, "-tcache")) {
+			if (value == NULL)
+				PANIC ("-tcache needs a count (use -h for help)");
+			thread_cache_max = atoi (value);
+		}
+		else if (!strcmp (name, "-switch")) {
+			if (value != NULL && !strcmp (value, "iret"))
+				thread_iret_switch = true;
+			else if (value == NULL || strcmp (value, "fast"))
+				PANIC ("unknown context switch `%s' (use -h for help)",
+						value != NULL ? value : "");
+		}
+		else if (!strcmp (name, "-dl-bw")) {
+			if (value == NULL)
+				PANIC ("-dl-bw needs a percentage (use -h for help)");
+			sched_dl_bw_limit = atoi (value);
+			if (sched_dl_bw_limit < 1 || sched_dl_bw_limit > 100)
+				PANIC ("deadline bandwidth must be 1 to 100 percent");
+		}
+		else if (!strcmp (name, "-tickless"))
+			timer_tickless = true;
+		else if (!strcmp (name, "-nolapic"))
+			lapic_disabled = true;
+		else if (!strcmp (name, "-irqsoff"))
+			irqsoff_init (value != NULL ? atoi (value) : 8);
+		else if (!strcmp (name, "-profile"))
+			profile_init (value != NULL ? atoi (value) : 1);
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
@@ -252,6 +310,12 @@ run_task (char **argv) {
 	printf ("Execution of '%s' complete.\n", task);
 }
 
+/* Prints the longest interrupts-off sections so far. */
+static void
+run_irqsoff (char **argv UNUSED) {
+	irqsoff_print_stats ();
+}
+
 /* Executes all of the actions specified in ARGV[]
    up to the null pointer sentinel. */
 static void
@@ -266,6 +330,7 @@ run_actions (char **argv) {
 	/* Table of supported actions. */
 	static const struct action actions[] = {
 		{"run", 2, run_task},
+		{"irqsoff", 1, run_irqsoff},
 #ifdef FILESYS
 		{"ls", 1, fsutil_ls},
 		{"cat", 2, fsutil_cat},
@@ -312,6 +377,7 @@ usage (void) {
 #else
 			"  run TEST           Run TEST.\n"
 #endif
+			"  irqsoff            Print the longest interrupts-off sections so far.\n"
 #ifdef FILESYS
 			"  ls                 List files in the root directory.\n"
 			"  cat FILE           Print FILE to the console.\n"
@@ -326,6 +392,18 @@ usage (void) {
 			"  -f                 Format file system disk during startup.\n"
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
+			"  -sched=SCHED       Use scheduler SCHED: prio, mlfqs or cfs.\n"
+			"  -dl-bw=PERCENT     Let deadline threads reserve up to PERCENT of CPU.\n"
+			"  -switch=MODE       Switch threads with MODE: fast (default) or iret.\n"
+			"  -kstack=KB         Give each thread a KB kB kernel stack (8 or 16).\n"
+			"  -tcache=N          Keep up to N freed thread stacks for reuse.\n"
+			"  -palloc-check      Check page allocations against a bitmap.\n"
+			"  -tickless          Stop the periodic timer tick while idle.\n"
+			"  -nolapic           Ignore the local APIC: PIT timers only.\n"
+			"  -irqsoff[=N]       Trace the N (default 8) longest interrupts-off\n"
+			"                     sections; print them at shutdown and with `irqsoff'.\n"
+			"  -profile[=N]       Sample the CPU every N (default 1) timer ticks;\n"
+			"                     print folded stacks at shutdown.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
 #endif
@@ -353,12 +431,20 @@ power_off (void) {
 static void
 print_stats (void) {
 	timer_print_stats ();
+	hrtimer_print_stats ();
 	thread_print_stats ();
+	palloc_print_stats ();
+	kmem_print_stats ();
 #ifdef FILESYS
 	disk_print_stats ();
 #endif
 	console_print_stats ();
 	kbd_print_stats ();
+	irqsoff_print_stats ();
+	profile_print_stats ();
+#ifdef LOCKSTAT
+	lockstat_print_stats ();
+#endif
 #ifdef USERPROG
 	exception_print_stats ();
 #endif
@@ -6,9 +6,12 @@
 #include "threads/flags.h"
 #include "threads/intr-stubs.h"
 #include "threads/io.h"
+#include "threads/irqsoff.h"
+#include "threads/lapic.h"
 #include "threads/thread.h"
 #include "threads/mmu.h"
 #include "threads/vaddr.h"
+#include "threads/workqueue.h"
 #include "devices/timer.h"
 #include "intrinsic.h"
 #ifdef USERPROG
@@ -93,6 +96,10 @@ static intr_handler_func *intr_handlers[INTR_CNT];
 /* Names for each interrupt, for debugging purposes. */
 static const char *intr_names[INTR_CNT];
 
+/* External interrupts delivered by the local APIC rather than
+   the PICs.  See intr_register_apic(). */
+static bool apic_vecs[INTR_CNT];
+
 /* External interrupts are those generated by devices outside the
    CPU, such as the timer.  External interrupts run with
    interrupts turned off, so they never nest, nor are they ever
@@ -103,6 +110,12 @@ static const char *intr_names[INTR_CNT];
 static bool in_external_intr;   /* Are we processing an external interrupt? */
 static bool yield_on_return;    /* Should we yield on interrupt return? */
 
+/* Deferred softirq work runs at the end of the outermost external
+   interrupt, with interrupts on.  It counts as interrupt context:
+   it may not sleep, but it may call intr_yield_on_return(), and
+   external interrupts may nest inside it. */
+static bool in_softirq;         /* Are we running softirq work? */
+
 /* Programmable Interrupt Controller helpers. */
 static void pic_init (void);
 static void pic_end_of_interrupt (int irq);
@@ -124,18 +137,41 @@ intr_get_level (void) {
 	return flags & FLAG_IF ? INTR_ON : INTR_OFF;
 }
 
+static enum intr_level enable (void **frame);
+static enum intr_level disable (void **frame);
+
 /* Enables or disables interrupts as specified by LEVEL and
    returns the previous interrupt status. */
 enum intr_level
 intr_set_level (enum intr_level level) {
-	return level == INTR_ON ? intr_enable () : intr_disable ();
+	void **frame = __builtin_frame_address (0);
+	return level == INTR_ON ? enable (frame) : disable (frame);
 }
 
 /* Enables interrupts and returns the previous interrupt status. */
 enum intr_level
 intr_enable (void) {
+	return enable (__builtin_frame_address (0));
+}
+
+/* Disables interrupts and returns the previous interrupt status. */
+enum intr_level
+intr_disable (void) {
+	return disable (__builtin_frame_address (0));
+}
+
+/* Enables interrupts on behalf of the function whose stack frame
+   is FRAME, for the irqsoff tracer. */
+static enum intr_level
+enable (void **frame) {
 	enum intr_level old_level = intr_get_level ();
-	ASSERT (!intr_context ());
+
+	/* Softirq work may turn interrupts on, but external interrupt
+	   handlers may not. */
+	ASSERT (!in_external_intr);
+
+	if (irqsoff_enabled && old_level == INTR_OFF)
+		irqsoff_end (frame[1]);
 
 	/* Enable interrupts by setting the interrupt flag.
 
@@ -146,9 +182,10 @@ intr_enable (void) {
 	return old_level;
 }
 
-/* Disables interrupts and returns the previous interrupt status. */
-enum intr_level
-intr_disable (void) {
+/* Disables interrupts on behalf of the function whose stack
+   frame is FRAME, for the irqsoff tracer. */
+static enum intr_level
+disable (void **frame) {
 	enum intr_level old_level = intr_get_level ();
 
 	/* Disable interrupts by clearing the interrupt flag.
@@ -156,6 +193,9 @@ intr_disable (void) {
 	   Hardware Interrupts". */
 	asm volatile ("cli" : : : "memory");
 
+	if (irqsoff_enabled && old_level == INTR_ON)
+		irqsoff_begin (frame);
+
 	return old_level;
 }
 
@@ -221,6 +261,17 @@ register_handler (uint8_t vec_no, int dpl, enum intr_level level,
 	intr_names[vec_no] = name;
 }
 
+/* Makes interrupt VEC_NO, which must already be registered,
+   switch to entry IST (1...7) of the TSS's interrupt stack table,
+   so that its handler runs on a known-good stack even if the
+   interrupted code's stack is not.  IST 0 turns this off. */
+void
+intr_set_ist (uint8_t vec_no, int ist) {
+	ASSERT (intr_handlers[vec_no] != NULL);
+	ASSERT (ist >= 0 && ist <= 7);
+	idt[vec_no].ist = ist;
+}
+
 /* Registers external interrupt VEC_NO to invoke HANDLER, which
    is named NAME for debugging purposes.  The handler will
    execute with interrupts disabled. */
@@ -231,6 +282,19 @@ intr_register_ext (uint8_t vec_no, intr_handler_func *handler,
 	register_handler (vec_no, 0, INTR_OFF, handler, name);
 }
 
+/* Registers external interrupt VEC_NO, raised by the local APIC
+   itself, such as its timer, to invoke HANDLER, which is named
+   NAME for debugging purposes.  Like the PIC's interrupts, it is
+   handled as an external interrupt, but acknowledged on the
+   local APIC. */
+void
+intr_register_apic (uint8_t vec_no, intr_handler_func *handler,
+		const char *name) {
+	ASSERT (vec_no >= 0x30);
+	register_handler (vec_no, 0, INTR_OFF, handler, name);
+	apic_vecs[vec_no] = true;
+}
+
 /* Registers internal interrupt VEC_NO to invoke HANDLER, which
    is named NAME for debugging purposes.  The interrupt handler
    will be invoked with interrupt status LEVEL.
@@ -252,11 +316,12 @@ intr_register_int (uint8_t vec_no, int dpl, enum intr_level level,
 	register_handler (vec_no, dpl, level, handler, name);
 }
 
-/* Returns true during processing of an external interrupt
-   and false at all other times. */
+/* Returns true during processing of an external interrupt,
+   including the softirq work run as it returns, and false at all
+   other times. */
 bool
 intr_context (void) {
-	return in_external_intr;
+	return in_external_intr || in_softirq;
 }
 
 /* During processing of an external interrupt, directs the
@@ -336,13 +401,17 @@ intr_handler (struct intr_frame *frame) {
 	   We only handle one at a time (so interrupts must be off)
 	   and they need to be acknowledged on the PIC (see below).
 	   An external interrupt handler cannot sleep. */
-	external = frame->vec_no >= 0x20 && frame->vec_no < 0x30;
+	external = (frame->vec_no >= 0x20 && frame->vec_no < 0x30)
+		|| apic_vecs[frame->vec_no];
+	if (irqsoff_enabled && (frame->eflags & FLAG_IF))
+		irqsoff_begin_intr (frame);
 	if (external) {
 		ASSERT (intr_get_level () == INTR_OFF);
-		ASSERT (!intr_context ());
+		ASSERT (!in_external_intr);
 
 		in_external_intr = true;
-		yield_on_return = false;
+		if (!in_softirq)
+			yield_on_return = false;
 	}
 
 	/* Invoke the interrupt's handler. */
@@ -366,11 +435,27 @@ intr_handler (struct intr_frame *frame) {
 		ASSERT (intr_context ());
 
 		in_external_intr = false;
-		pic_end_of_interrupt (frame->vec_no);
-
-		if (yield_on_return)
-			thread_yield ();
+		if (apic_vecs[frame->vec_no])
+			lapic_eoi ();
+		else
+			pic_end_of_interrupt (frame->vec_no);
+
+		/* An interrupt that came in during softirq work leaves
+		   any new work, and the yield, to the outer one. */
+		if (!in_softirq) {
+			in_softirq = true;
+			softirq_run ();
+			in_softirq = false;
+
+			if (yield_on_return)
+				thread_yield ();
+		}
 	}
+
+	/* `iret' turns interrupts back on if they were on before. */
+	if (irqsoff_enabled && (frame->eflags & FLAG_IF)
+			&& intr_get_level () == INTR_OFF)
+		irqsoff_end ((void *) frame->rip);
 }
 
 /* Dumps interrupt frame F to the console, for debugging. */
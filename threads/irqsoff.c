@@ -0,0 +1,191 @@
+#include "threads/irqsoff.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+/* Interrupts-off latency tracer, enabled with "-irqsoff=N".
+
+   Every transition of the interrupt flag made by intr_disable(),
+   intr_enable() and intr_set_level(), or by the CPU on entry to
+   and return from an interrupt, is timestamped with the TSC.
+   When interrupts come back on, the section that just ended is
+   compared with the N longest seen so far, keeping at most one
+   per site: the caller of intr_disable(), or the interrupt.
+
+   Some transitions are made outside these functions, by `sti'
+   in the idle thread and the system call entry path, or by
+   `iret' to user mode.  A section whose end we miss is replaced
+   by the next one to start, rather than counted until some later
+   intr_enable(). */
+
+/* Is the tracer on? */
+bool irqsoff_enabled;
+
+/* Longest sections, in decreasing order of length. */
+static struct irqsoff_section worst[IRQSOFF_MAX];
+static int worst_cnt;           /* Number of entries in worst[]. */
+static int worst_max;           /* Maximum entries to keep. */
+
+static uint64_t section_cnt;    /* Number of sections measured. */
+
+/* The section in progress, if OPEN. */
+static struct irqsoff_section cur;
+static uint64_t cur_start;
+static bool open;
+
+/* Turns on the tracer, keeping the CNT longest sections. */
+void
+irqsoff_init (int cnt) {
+	if (cnt < 1 || cnt > IRQSOFF_MAX)
+		PANIC ("irqsoff can keep 1 to %d sections, not %d", IRQSOFF_MAX, cnt);
+	worst_max = cnt;
+	irqsoff_enabled = true;
+}
+
+/* Returns true if sections A and B started at the same site. */
+static bool
+same_site (const struct irqsoff_section *a, const struct irqsoff_section *b) {
+	if (a->intr != NULL || b->intr != NULL)
+		return a->intr == b->intr;
+	return a->off[0] == b->off[0];
+}
+
+/* Adds S to worst[], if it is among the longest. */
+static void
+record (const struct irqsoff_section *s) {
+	int i;
+
+	if (worst_cnt == worst_max && s->cycles <= worst[worst_cnt - 1].cycles)
+		return;
+
+	/* Keep only the longest section per site. */
+	for (i = 0; i < worst_cnt; i++)
+		if (same_site (&worst[i], s)) {
+			if (s->cycles <= worst[i].cycles)
+				return;
+			memmove (&worst[i], &worst[i + 1],
+					(worst_cnt - i - 1) * sizeof *worst);
+			worst_cnt--;
+			break;
+		}
+	if (worst_cnt == worst_max)
+		worst_cnt--;
+
+	for (i = worst_cnt; i > 0 && worst[i - 1].cycles < s->cycles; i--)
+		worst[i] = worst[i - 1];
+	worst[i] = *s;
+	worst_cnt++;
+}
+
+/* Starts a section at the current time. */
+static void
+start (void) {
+	cur_start = rdtsc ();
+	open = true;
+}
+
+/* Copies up to IRQSOFF_DEPTH - FIRST return addresses into
+   cur.off[], starting at index FIRST, from the frame-pointer
+   chain that begins at FRAME. */
+static void
+backtrace (void **frame, int first) {
+	int i;
+
+	for (i = first; i < IRQSOFF_DEPTH; i++) {
+		if (frame == NULL || !is_kernel_vaddr (frame) || frame[0] == NULL)
+			break;
+		cur.off[i] = frame[1];
+		frame = frame[0];
+	}
+	for (; i < IRQSOFF_DEPTH; i++)
+		cur.off[i] = NULL;
+}
+
+/* Called with interrupts just turned off by a function whose
+   stack frame is FRAME. */
+void
+irqsoff_begin (void **frame) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	cur.intr = NULL;
+	backtrace (frame, 0);
+	start ();
+}
+
+/* Called on entry to interrupt F, which interrupted code that
+   ran with interrupts on. */
+void
+irqsoff_begin_intr (const struct intr_frame *f) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	cur.intr = intr_name (f->vec_no);
+	cur.off[0] = (void *) f->rip;
+	backtrace (is_kernel_vaddr (f->rip) ? (void **) f->R.rbp : NULL, 1);
+	start ();
+}
+
+/* Called with interrupts about to be turned on at CALLER.  Ends
+   the current section, if one is open. */
+void
+irqsoff_end (void *caller) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (!open)
+		return;
+	open = false;
+	cur.cycles = rdtsc () - cur_start;
+	cur.on = caller;
+	section_cnt++;
+	record (&cur);
+}
+
+/* Returns the length of the longest section so far, in TSC
+   cycles. */
+uint64_t
+irqsoff_worst (void) {
+	enum intr_level old_level = intr_disable ();
+	uint64_t cycles = worst_cnt > 0 ? worst[0].cycles : 0;
+
+	intr_set_level (old_level);
+	return cycles;
+}
+
+/* Prints the longest sections. */
+void
+irqsoff_print_stats (void) {
+	static struct irqsoff_section copy[IRQSOFF_MAX];
+	enum intr_level old_level;
+	uint64_t cnt;
+	int i, j, n;
+
+	if (!irqsoff_enabled)
+		return;
+
+	old_level = intr_disable ();
+	n = worst_cnt;
+	memcpy (copy, worst, n * sizeof *worst);
+	cnt = section_cnt;
+	intr_set_level (old_level);
+
+	printf ("irqsoff: %d longest of %llu sections with interrupts off:\n",
+			n, (unsigned long long) cnt);
+	for (i = 0; i < n; i++) {
+		const struct irqsoff_section *s = &copy[i];
+
+		printf ("%12llu ns off",
+				(unsigned long long) timer_cycles_to_ns (s->cycles));
+		if (s->intr != NULL)
+			printf (" by %s", s->intr);
+		printf (" at");
+		for (j = 0; j < IRQSOFF_DEPTH && s->off[j] != NULL; j++)
+			printf (" %p", s->off[j]);
+		printf (", on at %p\n", s->on);
+	}
+	printf ("irqsoff: max %llu cycles, %llu ns\n",
+			(unsigned long long) (n > 0 ? copy[0].cycles : 0),
+			(unsigned long long) timer_cycles_to_ns (n > 0 ? copy[0].cycles : 0));
+}
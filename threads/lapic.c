@@ -0,0 +1,152 @@
+#include "threads/lapic.h"
+#include <debug.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/mmu.h"
+#include "threads/synch.h"
+#include "intrinsic.h"
+
+/* Local APIC.
+
+   Used as a one-shot timer with far better resolution than the
+   8254 (see devices/hrtimer.c).  Device interrupts still go
+   through the 8259A PICs. */
+
+/* CPUID leaf 1 EDX bit: the CPU has a local APIC. */
+#define CPUID_APIC (1 << 9)
+
+/* IA32_APIC_BASE model-specific register and its bits. */
+#define MSR_APIC_BASE 0x1b
+#define APIC_BASE_ENABLE (1 << 11)
+#define APIC_BASE_ADDR 0xfffff000
+
+#define SVR_ENABLE 0x100        /* APIC software enable. */
+
+/* Timer LVT entry bits.  One-shot mode is 0. */
+#define LVT_MASKED 0x10000
+
+/* Divide the timer's input clock by 16. */
+#define DCR_DIVIDE_16 0x3
+
+/* Vector for spurious local APIC interrupts. */
+#define SPURIOUS_VEC 0xff
+
+/* Ticks to measure the timer over. */
+#define CALIBRATE_TICKS 10
+
+/* If true, act as if there were no local APIC. */
+bool lapic_disabled;
+
+static volatile uint32_t *lapic;
+
+static void spurious_handler (struct intr_frame *);
+
+/* Returns true if CPUID reports a local APIC. */
+static bool
+has_lapic (void) {
+	uint32_t eax = 1, ebx, ecx = 0, edx;
+
+	asm volatile ("cpuid" : "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx));
+	return (edx & CPUID_APIC) != 0;
+}
+
+/* Maps and enables the local APIC, if the CPU has one and it is
+   not disabled.  Returns true if it is usable.  May be called
+   more than once. */
+bool
+lapic_init (void) {
+	uint64_t base;
+
+	if (lapic != NULL)
+		return true;
+	if (lapic_disabled || !has_lapic ())
+		return false;
+
+	base = read_msr (MSR_APIC_BASE);
+	if (!(base & APIC_BASE_ENABLE))
+		write_msr (MSR_APIC_BASE, base |= APIC_BASE_ENABLE);
+	lapic = mmio_map (base & APIC_BASE_ADDR);
+
+	intr_register_int (SPURIOUS_VEC, 0, INTR_OFF, spurious_handler,
+			"APIC Spurious Interrupt");
+	lapic_write (LAPIC_TPR, 0);
+	lapic_write (LAPIC_SVR, SVR_ENABLE | SPURIOUS_VEC);
+	return true;
+}
+
+/* Returns true if lapic_init() found a usable local APIC. */
+bool
+lapic_present (void) {
+	return lapic != NULL;
+}
+
+/* Returns the value of local APIC register REG. */
+uint32_t
+lapic_read (int reg) {
+	ASSERT (lapic != NULL);
+	return lapic[reg / 4];
+}
+
+/* Sets local APIC register REG to VALUE. */
+void
+lapic_write (int reg, uint32_t value) {
+	ASSERT (lapic != NULL);
+	lapic[reg / 4] = value;
+	(void) lapic[LAPIC_ID / 4];	/* Wait for the write to finish. */
+}
+
+/* Acknowledges the interrupt being handled. */
+void
+lapic_eoi (void) {
+	lapic_write (LAPIC_EOI, 0);
+}
+
+/* Waits until the timer tick count changes. */
+static void
+wait_for_tick (void) {
+	int64_t start = timer_ticks ();
+
+	while (timer_ticks () == start)
+		barrier ();
+}
+
+/* Sets up the local APIC timer to raise one-shot interrupts on
+   vector VEC and calibrates it against the PIT.  Returns its
+   frequency in counts per second, or 0 if it is unusable.
+   Interrupts must be on. */
+uint64_t
+lapic_timer_init (uint8_t vec) {
+	uint32_t remaining;
+
+	ASSERT (intr_get_level () == INTR_ON);
+	if (!lapic_init ())
+		return 0;
+
+	lapic_write (LAPIC_TIMER_DCR, DCR_DIVIDE_16);
+	lapic_write (LAPIC_LVT_TIMER, LVT_MASKED | vec);
+
+	/* Count down from the top over CALIBRATE_TICKS ticks. */
+	wait_for_tick ();
+	lapic_write (LAPIC_TIMER_ICR, UINT32_MAX);
+	for (int i = 0; i < CALIBRATE_TICKS; i++)
+		wait_for_tick ();
+	remaining = lapic_read (LAPIC_TIMER_CCR);
+	lapic_write (LAPIC_TIMER_ICR, 0);
+
+	if (remaining == 0)
+		return 0;
+	lapic_write (LAPIC_LVT_TIMER, vec);
+	return (uint64_t) (UINT32_MAX - remaining) * TIMER_FREQ / CALIBRATE_TICKS;
+}
+
+/* Arms the local APIC timer to interrupt after COUNT counts, or
+   stops it if COUNT is 0. */
+void
+lapic_timer_oneshot (uint32_t count) {
+	lapic_write (LAPIC_TIMER_ICR, count);
+}
+
+/* Spurious local APIC interrupts need no EOI. */
+static void
+spurious_handler (struct intr_frame *f UNUSED) {
+}
@@ -0,0 +1,184 @@
+#include "threads/lockstat.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "devices/timer.h"
+#include "intrinsic.h"
+
+#ifdef LOCKSTAT
+
+/* Lock contention statistics, compiled in when LOCKSTAT is
+   defined, e.g. with "make LOCKSTAT=1".
+
+   Locks are grouped into classes by the lock_init() call that
+   initialized them, so that, for example, the locks of all the
+   malloc() descriptors are reported together.  For each class
+   we count acquisitions and acquisitions that found the lock
+   held, and measure with the TSC how long acquirers waited and
+   how long holders kept the lock.  All updates are made with
+   interrupts off, from lock_acquire() and friends, which turn
+   interrupts off anyway.
+
+   print_stats() prints the classes at shutdown, by total wait
+   time, and user programs may read them with lockstat(). */
+
+/* All classes with at least one initialized lock. */
+static struct lock_class *all_classes;
+
+/* Adds CLASS to the list of all classes, the first time one of
+   its locks is initialized. */
+void
+lockstat_register (struct lock_class *class) {
+	enum intr_level old_level = intr_disable ();
+
+	if (!class->registered) {
+		const char *name = class->name;
+		const char *file = strrchr (class->file, '/');
+
+		if (*name == '&')
+			name++;
+		strlcpy (class->stat.name, name, sizeof class->stat.name);
+		strlcpy (class->stat.file, file != NULL ? file + 1 : class->file,
+				sizeof class->stat.file);
+		class->stat.line = class->line;
+		class->next = all_classes;
+		all_classes = class;
+		class->registered = true;
+	}
+	intr_set_level (old_level);
+}
+
+/* Records that the current thread acquired LOCK, after trying
+   since TSC time START.  CONTENDED is true if LOCK was held by
+   another thread at START. */
+void
+lockstat_acquired (struct lock *lock, uint64_t start, bool contended) {
+	struct lock_class *class = lock->class;
+	uint64_t now = rdtsc ();
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	lock->hold_start = now;
+	if (class == NULL)
+		return;
+	class->stat.acquired++;
+	if (contended) {
+		uint64_t wait = now - start;
+
+		class->stat.contended++;
+		class->stat.wait_total += wait;
+		if (wait > class->stat.wait_max)
+			class->stat.wait_max = wait;
+	}
+}
+
+/* Records that the current thread is about to release LOCK. */
+void
+lockstat_released (struct lock *lock) {
+	struct lock_class *class = lock->class;
+	uint64_t hold;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (class == NULL)
+		return;
+	hold = rdtsc () - lock->hold_start;
+	class->stat.hold_total += hold;
+	if (hold > class->stat.hold_max)
+		class->stat.hold_max = hold;
+}
+
+/* Sorts the list of all classes by decreasing total wait time,
+   then decreasing acquisitions.  There are only as many classes
+   as lock_init() calls, so insertion sort will do. */
+static void
+sort_classes (void) {
+	struct lock_class *sorted = NULL;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (all_classes != NULL) {
+		struct lock_class *class = all_classes;
+		struct lock_class **p;
+
+		all_classes = class->next;
+		for (p = &sorted; *p != NULL; p = &(*p)->next) {
+			const struct lockstat *s = &(*p)->stat;
+
+			if (class->stat.wait_total > s->wait_total
+					|| (class->stat.wait_total == s->wait_total
+						&& class->stat.acquired > s->acquired))
+				break;
+		}
+		class->next = *p;
+		*p = class;
+	}
+	all_classes = sorted;
+}
+
+/* Copies the statistics of up to CNT classes, sorted as by
+   sort_classes(), into BUF, which may be in user memory.
+   Returns the total number of classes. */
+int
+lockstat_copy (struct lockstat *buf, int cnt) {
+	struct lock_class *class;
+	enum intr_level old_level;
+	int i = 0;
+
+	old_level = intr_disable ();
+	sort_classes ();
+	class = all_classes;
+	intr_set_level (old_level);
+
+	/* Classes are never removed and new ones are added at the
+	   front, so the list can be walked with interrupts on.  A
+	   concurrent sort may reorder it under us, which at worst
+	   skips or repeats a class. */
+	for (; class != NULL; class = class->next, i++)
+		if (i < cnt) {
+			struct lockstat stat;
+
+			old_level = intr_disable ();
+			stat = class->stat;
+			intr_set_level (old_level);
+			buf[i] = stat;
+		}
+	return i;
+}
+
+/* Prints lock statistics. */
+void
+lockstat_print_stats (void) {
+	struct lock_class *class;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	sort_classes ();
+	class = all_classes;
+	intr_set_level (old_level);
+
+	printf ("Lock statistics (ns):\n");
+	printf ("%-20s %-18s %8s %8s %12s %10s %12s %10s\n",
+			"lock", "site", "acquired", "waited",
+			"wait-total", "wait-max", "hold-total", "hold-max");
+	for (; class != NULL; class = class->next) {
+		const struct lockstat *s = &class->stat;
+		char site[32];
+
+		if (s->acquired == 0)
+			continue;
+		snprintf (site, sizeof site, "%s:%d", s->file, s->line);
+		printf ("%-20s %-18s %8llu %8llu %12llu %10llu %12llu %10llu\n",
+				s->name, site,
+				(unsigned long long) s->acquired,
+				(unsigned long long) s->contended,
+				(unsigned long long) timer_cycles_to_ns (s->wait_total),
+				(unsigned long long) timer_cycles_to_ns (s->wait_max),
+				(unsigned long long) timer_cycles_to_ns (s->hold_total),
+				(unsigned long long) timer_cycles_to_ns (s->hold_max));
+	}
+}
+
+#endif /* LOCKSTAT */
@@ -32,7 +32,18 @@
    because they're too big to fit in a single page with a
    descriptor.  We handle those by allocating contiguous pages
    with the page allocator and sticking the allocation size at
-   the beginning of the allocated block's arena header. */
+   the beginning of the allocated block's arena header.
+
+   Freed big blocks are kept, up to EXTENT_CACHE_PAGES pages in
+   all, in a cache of free extents, which later big requests
+   take from before going to the page allocator.  The page
+   allocator empties the cache through malloc_reclaim() when the
+   kernel pool runs out.
+
+   realloc() resizes in place when it can: a block that still
+   fits its descriptor's block size stays put, and a big block
+   shrinks by giving back its last pages or grows by claiming the
+   pages after it, if they are free. */
 
 /* Descriptor. */
 struct desc {
@@ -61,6 +72,14 @@ struct block {
 static struct desc descs[10];   /* Descriptors. */
 static size_t desc_cnt;         /* Number of descriptors. */
 
+/* Most pages to keep in freed big blocks for reuse. */
+#define EXTENT_CACHE_PAGES 64
+
+/* Freed big blocks, each an arena with a block on this list. */
+static struct list extent_cache;
+static size_t extent_cache_pages;   /* Pages in extent_cache. */
+static struct lock extent_lock;     /* Protects extent_cache. */
+
 static struct arena *block_to_arena (struct block *);
 static struct block *arena_to_block (struct arena *, size_t idx);
 
@@ -77,6 +96,84 @@ malloc_init (void) {
 		list_init (&d->free_list);
 		lock_init (&d->lock);
 	}
+	list_init (&extent_cache);
+	lock_init (&extent_lock);
+}
+
+/* Returns a big block of PAGE_CNT pages, from the extent cache if
+   possible, or a null pointer if memory is not available. */
+static struct arena *
+big_alloc (size_t page_cnt) {
+	struct arena *best = NULL;
+	struct list_elem *e;
+
+	/* Take the smallest cached extent that is large enough, and
+	   give back any pages past PAGE_CNT. */
+	lock_acquire (&extent_lock);
+	for (e = list_begin (&extent_cache); e != list_end (&extent_cache);
+			e = list_next (e)) {
+		struct arena *a = pg_round_down (list_entry (e, struct block, free_elem));
+		if (a->free_cnt >= page_cnt
+				&& (best == NULL || a->free_cnt < best->free_cnt))
+			best = a;
+	}
+	if (best != NULL) {
+		list_remove (&((struct block *) (best + 1))->free_elem);
+		extent_cache_pages -= best->free_cnt;
+	}
+	lock_release (&extent_lock);
+
+	if (best == NULL)
+		return palloc_get_multiple (0, page_cnt);
+	palloc_free_multiple ((uint8_t *) best + page_cnt * PGSIZE,
+			best->free_cnt - page_cnt);
+	return best;
+}
+
+/* Frees big block A, keeping it in the extent cache if there is
+   room. */
+static void
+big_free (struct arena *a) {
+	struct block *b = (struct block *) (a + 1);
+
+	lock_acquire (&extent_lock);
+	if (extent_cache_pages + a->free_cnt <= EXTENT_CACHE_PAGES) {
+#ifndef NDEBUG
+		/* Clear the block past its free list element to help detect
+		   use-after-free bugs, as palloc does for the pages it frees. */
+		memset (b + 1, 0xcc, PGSIZE * a->free_cnt - sizeof *a - sizeof *b);
+#endif
+		list_push_front (&extent_cache, &b->free_elem);
+		extent_cache_pages += a->free_cnt;
+		lock_release (&extent_lock);
+		return;
+	}
+	lock_release (&extent_lock);
+	palloc_free_multiple (a, a->free_cnt);
+}
+
+/* Gives every extent in the extent cache back to the page
+   allocator.  Called by palloc when the kernel pool runs out.
+   Returns true if any pages were freed. */
+bool
+malloc_reclaim (void) {
+	bool freed = false;
+
+	for (;;) {
+		struct arena *a = NULL;
+
+		lock_acquire (&extent_lock);
+		if (!list_empty (&extent_cache)) {
+			a = pg_round_down (list_entry (list_pop_front (&extent_cache),
+						struct block, free_elem));
+			extent_cache_pages -= a->free_cnt;
+		}
+		lock_release (&extent_lock);
+		if (a == NULL)
+			return freed;
+		palloc_free_multiple (a, a->free_cnt);
+		freed = true;
+	}
 }
 
 /* Obtains and returns a new block of at least SIZE bytes.
@@ -100,7 +197,7 @@ malloc (size_t size) {
 		/* SIZE is too big for any descriptor.
 		   Allocate enough pages to hold SIZE plus an arena. */
 		size_t page_cnt = DIV_ROUND_UP (size + sizeof *a, PGSIZE);
-		a = palloc_get_multiple (0, page_cnt);
+		a = big_alloc (page_cnt);
 		if (a == NULL)
 			return NULL;
 
@@ -173,6 +270,29 @@ block_size (void *block) {
 	return d != NULL ? d->block_size : PGSIZE * a->free_cnt - pg_ofs (block);
 }
 
+/* Tries to resize BLOCK to NEW_SIZE bytes without moving it.
+   Returns true if successful. */
+static bool
+resize_in_place (void *block, size_t new_size) {
+	struct arena *a = block_to_arena (block);
+	size_t page_cnt;
+
+	if (a->desc != NULL)
+		return new_size <= a->desc->block_size;
+
+	/* A big block.  Shrink or grow its run of pages. */
+	page_cnt = DIV_ROUND_UP (new_size + sizeof *a, PGSIZE);
+	if (page_cnt < a->free_cnt)
+		palloc_free_multiple ((uint8_t *) a + page_cnt * PGSIZE,
+				a->free_cnt - page_cnt);
+	else if (page_cnt > a->free_cnt
+			&& !palloc_claim ((uint8_t *) a + a->free_cnt * PGSIZE,
+					page_cnt - a->free_cnt))
+		return false;
+	a->free_cnt = page_cnt;
+	return true;
+}
+
 /* Attempts to resize OLD_BLOCK to NEW_SIZE bytes, possibly
    moving it in the process.
    If successful, returns the new block; on failure, returns a
@@ -184,6 +304,8 @@ realloc (void *old_block, size_t new_size) {
 	if (new_size == 0) {
 		free (old_block);
 		return NULL;
+	} else if (old_block != NULL && resize_in_place (old_block, new_size)) {
+		return old_block;
 	} else {
 		void *new_block = malloc (new_size);
 		if (old_block != NULL && new_block != NULL) {
@@ -233,7 +355,7 @@ free (void *p) {
 			lock_release (&d->lock);
 		} else {
 			/* It's a big block.  Free its pages. */
-			palloc_free_multiple (a, a->free_cnt);
+			big_free (a);
 			return;
 		}
 	}
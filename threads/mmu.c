@@ -313,3 +313,18 @@ pml4_set_accessed (uint64_t *pml4, const void *vpage, bool accessed) {
 			invlpg ((uint64_t) vpage);
 	}
 }
+
+/* Maps the page of device memory at physical address PA into the
+   kernel page table, uncached, and returns its virtual address.
+   User page tables share these mappings since they copy the
+   kernel's top-level entries. */
+void *
+mmio_map (uint64_t pa) {
+	void *va = ptov (pa);
+	uint64_t *pte = pml4e_walk (base_pml4, (uint64_t) va, 1);
+
+	ASSERT (pte != NULL);
+	*pte = (pa & ~(uint64_t) PGMASK) | PTE_P | PTE_W | PTE_PWT | PTE_PCD;
+	invlpg ((uint64_t) va);
+	return va;
+}
@@ -2,14 +2,18 @@
 #include <bitmap.h>
 #include <debug.h>
 #include <inttypes.h>
+#include <list.h>
 #include <round.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/init.h"
+#include "threads/interrupt.h"
 #include "threads/loader.h"
+#include "threads/malloc.h"
 #include "threads/synch.h"
+#include "threads/thread.h"
 #include "threads/vaddr.h"
 
 /* Page allocator.  Hands out memory in page-size (or
@@ -24,12 +28,97 @@
 
    By default, half of system RAM is given to the kernel pool and
    half to the user pool.  That should be huge overkill for the
-   kernel pool, but that's just fine for demonstration purposes. */
+   kernel pool, but that's just fine for demonstration purposes.
+
+   Each pool is managed by a binary buddy allocator.  Free memory
+   is kept in blocks of 2**ORDER pages, for ORDER from 0 up to
+   MAX_ORDER - 1, each aligned to its own size relative to the
+   pool's base, on one free list per order.  An allocation takes
+   a block of the smallest order that fits, splitting a larger
+   one if necessary, and gives back the pages past the end of the
+   request.  Freeing breaks the pages up into aligned blocks and
+   merges each with its "buddy", the other half of the block of
+   the next order up, for as long as the buddy is free too.  Both
+   take time logarithmic in the pool size.  palloc_claim()
+   allocates a given run of pages, if they are free, so that an
+   allocation can be extended in place.
+
+   Free pages are never written to.  Instead, each pool has two
+   arrays with an entry per page, allocated next to it at boot:
+   free_elem[] holds the list_elem of each free block's first
+   page, and order_map[] marks the first page of each free block
+   with the block's order, which is how freeing finds free
+   buddies.
+
+   Single pages, by far the most common request, normally bypass
+   the buddy allocator and its lock.  Each pool keeps a magazine,
+   a LIFO stack of up to MAG_SIZE free pages that are taken and
+   put back with interrupts off instead of under the pool lock.
+   An empty magazine is refilled, and a full one drained, by
+   MAG_BATCH pages at a time in one hold of the lock, and an
+   allocation that the buddy allocator cannot satisfy first
+   drains the magazine into it.  The scheduler runs only on the
+   bootstrap processor, so one magazine per pool is enough for
+   now; with threads on more CPUs, each CPU needs its own.
+
+   Requests for a single zeroed page are served, when possible,
+   from a stack of up to ZERO_SIZE pages per pool that the idle
+   thread zeroes ahead of time, whenever there is nothing else to
+   run, through palloc_zero_idle().  It leaves the last
+   ZERO_RESERVE free pages alone, and an allocation that fails
+   gives the pre-zeroed pages back, along with the magazine.
+
+   With "-palloc-check", every allocation and free is also
+   checked against a bitmap of the pages in use, catching double
+   frees and frees of pages that were never allocated.  Magazines
+   are bypassed, so that every free is checked. */
+
+/* Number of block orders.  The largest block, of order
+   MAX_ORDER - 1, is 2 MB. */
+#define MAX_ORDER 10
+
+/* order_map[] entry for the first page of a free block of order
+   ORDER.  Other pages' entries are 0. */
+#define FREE_BLOCK(ORDER) (0x80 | (ORDER))
+
+/* Pages a magazine holds at most, and pages moved between it and
+   the buddy allocator at once. */
+#define MAG_SIZE 32
+#define MAG_BATCH 16
+
+/* A magazine of free single pages.  Accessed with interrupts
+   off, without the pool lock except to refill or drain. */
+struct magazine {
+	size_t pages[MAG_SIZE];         /* Page indexes; top at cnt - 1. */
+	int cnt;                        /* Number of pages held. */
+};
+
+/* Most pre-zeroed pages to keep per pool. */
+#define ZERO_SIZE 64
+
+/* Pre-zero pages only while the pool has more free pages than
+   this. */
+#define ZERO_RESERVE 256
+
+/* Pages zeroed in advance.  Accessed with interrupts off. */
+struct zero_pool {
+	size_t pages[ZERO_SIZE];        /* Page indexes; top at cnt - 1. */
+	int cnt;                        /* Number of pages held. */
+	unsigned long long hits;        /* PAL_ZERO requests served. */
+	unsigned long long misses;      /* PAL_ZERO requests zeroed inline. */
+};
 
 /* A memory pool. */
 struct pool {
 	struct lock lock;               /* Mutual exclusion. */
-	struct bitmap *used_map;        /* Bitmap of free pages. */
+	struct magazine mag;            /* Cached free single pages. */
+	struct zero_pool zero;          /* Pre-zeroed pages. */
+	struct list free_list[MAX_ORDER];   /* Free blocks, by order. */
+	struct list_elem *free_elem;    /* Free list links, by page. */
+	uint8_t *order_map;             /* FREE_BLOCK() entries, by page. */
+	struct bitmap *used_map;        /* Pages in use, if palloc_check. */
+	size_t page_cnt;                /* Number of pages. */
+	size_t free_cnt;                /* Number of free pages. */
 	uint8_t *base;                  /* Base of pool. */
 };
 
@@ -38,10 +127,23 @@ static struct pool kernel_pool, user_pool;
 
 /* Maximum number of pages to put in user pool. */
 size_t user_page_limit = SIZE_MAX;
+
+/* Check allocations against a bitmap of pages in use?
+   Controlled by kernel command-line option "-palloc-check". */
+bool palloc_check;
+
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end);
 
 static bool page_from_pool (const struct pool *, void *page);
+static size_t pool_alloc (struct pool *, size_t page_cnt);
+static void pool_free (struct pool *, size_t page_idx, size_t page_cnt);
+static bool pool_claim (struct pool *, size_t page_idx, size_t page_cnt);
+static size_t mag_get (struct pool *);
+static void mag_put (struct pool *, size_t page_idx);
+static void mag_drain (struct pool *, int cnt);
+static size_t zero_get (struct pool *, size_t page_cnt);
+static void zero_drain (struct pool *);
 
 /* multiboot info */
 struct multiboot_info {
@@ -219,16 +321,16 @@ split:
 			else
 				NOT_REACHED ();
 
-			pool_end = pool->base + bitmap_size (pool->used_map) * PGSIZE;
+			pool_end = pool->base + pool->page_cnt * PGSIZE;
 			page_idx = pg_no (start) - pg_no (pool->base);
 			if ((uint64_t) pool_end < end) {
 				page_cnt = ((uint64_t) pool_end - start) / PGSIZE;
-				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				pool_free (pool, page_idx, page_cnt);
 				start = (uint64_t) pool_end;
 				goto split;
 			} else {
 				page_cnt = ((uint64_t) end - start) / PGSIZE;
-				bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+				pool_free (pool, page_idx, page_cnt);
 			}
 		}
 	}
@@ -262,19 +364,47 @@ palloc_init (void) {
 void *
 palloc_get_multiple (enum palloc_flags flags, size_t page_cnt) {
 	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
-
-	lock_acquire (&pool->lock);
-	size_t page_idx = bitmap_scan_and_flip (pool->used_map, 0, page_cnt, false);
-	lock_release (&pool->lock);
+	size_t page_idx = BITMAP_ERROR;
+	bool zeroed = false;
 	void *pages;
 
+	if (flags & PAL_ZERO) {
+		page_idx = zero_get (pool, page_cnt);
+		zeroed = page_idx != BITMAP_ERROR;
+	}
+	if (page_idx == BITMAP_ERROR && page_cnt == 1 && !palloc_check)
+		page_idx = mag_get (pool);
+	if (page_idx == BITMAP_ERROR) {
+		lock_acquire (&pool->lock);
+		page_idx = pool_alloc (pool, page_cnt);
+		if (page_idx == BITMAP_ERROR) {
+			/* Give back the pages set aside and retry. */
+			mag_drain (pool, pool->mag.cnt);
+			zero_drain (pool);
+			page_idx = pool_alloc (pool, page_cnt);
+		}
+		lock_release (&pool->lock);
+	}
+	if (page_idx == BITMAP_ERROR && pool == &kernel_pool) {
+		/* Cached thread stacks and malloc extents hold kernel pages
+		   too. */
+		bool freed = thread_cache_reclaim ();
+
+		freed = malloc_reclaim () || freed;
+		if (freed) {
+			lock_acquire (&pool->lock);
+			page_idx = pool_alloc (pool, page_cnt);
+			lock_release (&pool->lock);
+		}
+	}
+
 	if (page_idx != BITMAP_ERROR)
 		pages = pool->base + PGSIZE * page_idx;
 	else
 		pages = NULL;
 
 	if (pages) {
-		if (flags & PAL_ZERO)
+		if ((flags & PAL_ZERO) && !zeroed)
 			memset (pages, 0, PGSIZE * page_cnt);
 	} else {
 		if (flags & PAL_ASSERT)
@@ -318,8 +448,13 @@ palloc_free_multiple (void *pages, size_t page_cnt) {
 #ifndef NDEBUG
 	memset (pages, 0xcc, PGSIZE * page_cnt);
 #endif
-	ASSERT (bitmap_all (pool->used_map, page_idx, page_cnt));
-	bitmap_set_multiple (pool->used_map, page_idx, page_cnt, false);
+	if (page_cnt == 1 && !palloc_check)
+		mag_put (pool, page_idx);
+	else {
+		lock_acquire (&pool->lock);
+		pool_free (pool, page_idx, page_cnt);
+		lock_release (&pool->lock);
+	}
 }
 
 /* Frees the page at PAGE. */
@@ -328,23 +463,445 @@ palloc_free_page (void *page) {
 	palloc_free_multiple (page, 1);
 }
 
+/* Allocates the PAGE_CNT pages starting at PAGES, if they are all
+   free and in the same pool as the page just before PAGES.
+   Returns true if successful, false otherwise.  Useful to extend
+   an allocation that ends at PAGES in place. */
+bool
+palloc_claim (void *pages, size_t page_cnt) {
+	struct pool *pool;
+	size_t page_idx;
+	bool success;
+
+	ASSERT (pg_ofs (pages) == 0);
+	if (page_cnt == 0)
+		return true;
+
+	if (page_from_pool (&kernel_pool, pages))
+		pool = &kernel_pool;
+	else if (page_from_pool (&user_pool, pages))
+		pool = &user_pool;
+	else
+		return false;
+
+	/* The pools are adjacent, so a run at the start of one pool
+	   follows a block in the other. */
+	page_idx = pg_no (pages) - pg_no (pool->base);
+	if (page_idx == 0 || page_idx + page_cnt > pool->page_cnt)
+		return false;
+
+	lock_acquire (&pool->lock);
+	success = pool_claim (pool, page_idx, page_cnt);
+	lock_release (&pool->lock);
+	return success;
+}
+
+/* Copies the page counts of the user pool, if PAL_USER is set in
+   FLAGS, or of the kernel pool, into STATS. */
+void
+palloc_get_stats (enum palloc_flags flags, struct palloc_stats *stats) {
+	struct pool *pool = flags & PAL_USER ? &user_pool : &kernel_pool;
+
+	lock_acquire (&pool->lock);
+	stats->page_cnt = pool->page_cnt;
+	stats->free_cnt = pool->free_cnt + pool->mag.cnt;
+	stats->mag_cnt = pool->mag.cnt;
+	stats->zero_cnt = pool->zero.cnt;
+	stats->zero_hits = pool->zero.hits;
+	stats->zero_misses = pool->zero.misses;
+	lock_release (&pool->lock);
+}
+
+/* Zeroes a page ahead of time for a later PAL_ZERO request, if
+   a pool needs one.  Called by the idle thread, with interrupts
+   off, which it returns with.  Never blocks.  Returns true if it
+   zeroed a page, false if there was nothing to do. */
+bool
+palloc_zero_idle (void) {
+	struct pool *pools[] = {&kernel_pool, &user_pool};
+	size_t i;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	for (i = 0; i < sizeof pools / sizeof *pools; i++) {
+		struct pool *p = pools[i];
+		size_t page_idx;
+		uint64_t *page;
+		uint64_t cnt = PGSIZE / sizeof *page;
+
+		if (p->zero.cnt >= ZERO_SIZE || p->free_cnt <= ZERO_RESERVE
+				|| !lock_try_acquire (&p->lock))
+			continue;
+		page_idx = pool_alloc (p, 1);
+		lock_release (&p->lock);
+		if (page_idx == BITMAP_ERROR)
+			continue;
+
+		/* Only the idle thread adds pages, so there is still
+		   room afterward. */
+		page = (uint64_t *) (p->base + page_idx * PGSIZE);
+		intr_enable ();
+		asm volatile ("rep stosq"
+				: "+D" (page), "+c" (cnt) : "a" (0) : "memory");
+		intr_disable ();
+		ASSERT (p->zero.cnt < ZERO_SIZE);
+		p->zero.pages[p->zero.cnt++] = page_idx;
+		return true;
+	}
+	return false;
+}
+
+/* Prints page allocator statistics. */
+void
+palloc_print_stats (void) {
+	struct pool *pools[] = {&kernel_pool, &user_pool};
+	const char *names[] = {"kernel", "user"};
+	size_t i;
+
+	for (i = 0; i < sizeof pools / sizeof *pools; i++) {
+		struct pool *p = pools[i];
+		unsigned long long requests = p->zero.hits + p->zero.misses;
+
+		printf ("palloc: %s pool: %zu of %zu pages free, %d pre-zeroed, "
+				"%llu of %llu single-page PAL_ZERO requests pre-zeroed (%llu%%)\n",
+				names[i], p->free_cnt + p->mag.cnt, p->page_cnt, p->zero.cnt,
+				p->zero.hits, requests,
+				requests > 0 ? p->zero.hits * 100 / requests : 0);
+	}
+}
+
 /* Initializes pool P as starting at START and ending at END */
 static void
 init_pool (struct pool *p, void **bm_base, uint64_t start, uint64_t end) {
-  /* We'll put the pool's used_map at its base.
-     Calculate the space needed for the bitmap
-     and subtract it from the pool's size. */
+  /* We'll put the pool's free_elem, order_map and used_map at
+     *BM_BASE.  Calculate the space needed for them and advance
+     *BM_BASE past it. */
 	uint64_t pgcnt = (end - start) / PGSIZE;
+	size_t fe_bytes = ROUND_UP (pgcnt * sizeof *p->free_elem, PGSIZE);
+	size_t om_bytes = ROUND_UP (pgcnt, PGSIZE);
 	size_t bm_pages = DIV_ROUND_UP (bitmap_buf_size (pgcnt), PGSIZE) * PGSIZE;
+	int order;
 
 	lock_init(&p->lock);
-	p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
+	p->mag.cnt = 0;
+	p->zero = (struct zero_pool) { .cnt = 0 };
+	for (order = 0; order < MAX_ORDER; order++)
+		list_init (&p->free_list[order]);
+	p->page_cnt = pgcnt;
+	p->free_cnt = 0;
 	p->base = (void *) start;
 
-	// Mark all to unusable.
-	bitmap_set_all(p->used_map, true);
+	// Mark all to unusable: no free blocks, every page in use.
+	p->free_elem = *bm_base;
+	*bm_base += fe_bytes;
+	p->order_map = *bm_base;
+	memset (p->order_map, 0, pgcnt);
+	*bm_base += om_bytes;
+	if (palloc_check) {
+		p->used_map = bitmap_create_in_buf (pgcnt, *bm_base, bm_pages);
+		bitmap_set_all(p->used_map, true);
+		*bm_base += bm_pages;
+	}
+}
+
+/* Returns the list_elem of the free block at PAGE_IDX in P. */
+static struct list_elem *
+block_elem (struct pool *p, size_t page_idx) {
+	return &p->free_elem[page_idx];
+}
+
+/* Returns the index of the free block whose list_elem is E. */
+static size_t
+block_idx (struct pool *p, struct list_elem *e) {
+	return e - p->free_elem;
+}
+
+/* Adds the block of order ORDER at PAGE_IDX to P's free lists,
+   merging it with its buddy as long as the buddy is free. */
+static void
+free_block (struct pool *p, size_t page_idx, int order) {
+	while (order < MAX_ORDER - 1) {
+		size_t buddy = page_idx ^ ((size_t) 1 << order);
+
+		if (buddy + ((size_t) 1 << order) > p->page_cnt
+				|| p->order_map[buddy] != FREE_BLOCK (order))
+			break;
+		list_remove (block_elem (p, buddy));
+		p->order_map[buddy] = 0;
+		page_idx &= ~((size_t) 1 << order);
+		order++;
+	}
+	p->order_map[page_idx] = FREE_BLOCK (order);
+	list_push_front (&p->free_list[order], block_elem (p, page_idx));
+}
+
+/* Frees PAGE_CNT pages in P starting at PAGE_IDX, as the largest
+   aligned blocks that cover them. */
+static void
+free_range (struct pool *p, size_t page_idx, size_t page_cnt) {
+	while (page_cnt > 0) {
+		int order = 0;
+
+		while (order < MAX_ORDER - 1
+				&& page_idx % ((size_t) 2 << order) == 0
+				&& ((size_t) 2 << order) <= page_cnt)
+			order++;
+		free_block (p, page_idx, order);
+		page_idx += (size_t) 1 << order;
+		page_cnt -= (size_t) 1 << order;
+	}
+}
+
+/* Returns the smallest order whose blocks hold PAGE_CNT pages,
+   or MAX_ORDER if none does. */
+static int
+cnt_to_order (size_t page_cnt) {
+	int order = 0;
+
+	while (order < MAX_ORDER && ((size_t) 1 << order) < page_cnt)
+		order++;
+	return order;
+}
+
+/* Allocates PAGE_CNT contiguous pages from P, which must be
+   locked.  Returns the index of the first page, or BITMAP_ERROR
+   if no block is large enough. */
+static size_t
+pool_alloc (struct pool *p, size_t page_cnt) {
+	int want = cnt_to_order (page_cnt);
+	int order;
+	size_t page_idx;
+
+	for (order = want; order < MAX_ORDER; order++)
+		if (!list_empty (&p->free_list[order]))
+			break;
+	if (order >= MAX_ORDER)
+		return BITMAP_ERROR;
+
+	page_idx = block_idx (p, list_pop_front (&p->free_list[order]));
+	p->order_map[page_idx] = 0;
+
+	/* Split off the upper halves we do not need, then give back
+	   the pages past PAGE_CNT in the block that is left. */
+	while (order > want) {
+		order--;
+		p->order_map[page_idx + ((size_t) 1 << order)] = FREE_BLOCK (order);
+		list_push_front (&p->free_list[order],
+				block_elem (p, page_idx + ((size_t) 1 << order)));
+	}
+	free_range (p, page_idx + page_cnt, ((size_t) 1 << want) - page_cnt);
+	p->free_cnt -= page_cnt;
+
+	if (palloc_check) {
+		ASSERT (bitmap_none (p->used_map, page_idx, page_cnt));
+		bitmap_set_multiple (p->used_map, page_idx, page_cnt, true);
+	}
+	return page_idx;
+}
+
+/* Returns PAGE_CNT pages in P, starting at PAGE_IDX, to the free
+   lists.  P must be locked, unless the thread system is still
+   being set up. */
+static void
+pool_free (struct pool *p, size_t page_idx, size_t page_cnt) {
+	if (palloc_check) {
+		ASSERT (bitmap_all (p->used_map, page_idx, page_cnt));
+		bitmap_set_multiple (p->used_map, page_idx, page_cnt, false);
+	}
+	free_range (p, page_idx, page_cnt);
+	p->free_cnt += page_cnt;
+}
+
+/* Finds the free block in P that contains the page at PAGE_IDX.
+   Returns the block's order and stores the index of its first
+   page in *BLOCK_IDX, or returns -1 if the page is not free. */
+static int
+find_free_block (struct pool *p, size_t page_idx, size_t *block_idx) {
+	int order;
+
+	for (order = 0; order < MAX_ORDER; order++) {
+		size_t head = page_idx & ~(((size_t) 1 << order) - 1);
+
+		if (p->order_map[head] == FREE_BLOCK (order)) {
+			*block_idx = head;
+			return order;
+		}
+	}
+	return -1;
+}
+
+/* Returns the position of the page at PAGE_IDX in P's magazine,
+   or -1 if it is not there. */
+static int
+mag_find (struct pool *p, size_t page_idx) {
+	int i;
+
+	for (i = 0; i < p->mag.cnt; i++)
+		if (p->mag.pages[i] == page_idx)
+			return i;
+	return -1;
+}
+
+/* Allocates the PAGE_CNT pages in P starting at PAGE_IDX, if they
+   are all free, by splitting them out of the free blocks they
+   are in or taking them out of the magazine.  P must be locked.
+   Returns true if successful. */
+static bool
+pool_claim (struct pool *p, size_t page_idx, size_t page_cnt) {
+	size_t end = page_idx + page_cnt;
+	enum intr_level old_level;
+	size_t i, head;
+	int order;
+
+	/* Check first, so that failure changes nothing. */
+	old_level = intr_disable ();
+	for (i = page_idx; i < end; i = head + ((size_t) 1 << order)) {
+		order = find_free_block (p, i, &head);
+		if (order < 0) {
+			if (mag_find (p, i) < 0) {
+				intr_set_level (old_level);
+				return false;
+			}
+			head = i;
+			order = 0;
+		}
+	}
+
+	for (i = page_idx; i < end; ) {
+		size_t block_end;
+
+		order = find_free_block (p, i, &head);
+		if (order < 0) {
+			struct magazine *mag = &p->mag;
+			int pos = mag_find (p, i);
+
+			memmove (&mag->pages[pos], &mag->pages[pos + 1],
+					(mag->cnt - pos - 1) * sizeof *mag->pages);
+			mag->cnt--;
+			i++;
+			continue;
+		}
+		block_end = head + ((size_t) 1 << order);
+		list_remove (block_elem (p, head));
+		p->order_map[head] = 0;
+		free_range (p, head, i - head);
+		if (block_end > end)
+			free_range (p, end, block_end - end);
+		p->free_cnt -= (block_end < end ? block_end : end) - i;
+		i = block_end;
+	}
+	intr_set_level (old_level);
+
+	if (palloc_check) {
+		ASSERT (bitmap_none (p->used_map, page_idx, page_cnt));
+		bitmap_set_multiple (p->used_map, page_idx, page_cnt, true);
+	}
+	return true;
+}
+
+/* Takes a page from P's magazine, refilling it first if it is
+   empty.  Returns the page's index, or BITMAP_ERROR if P is out
+   of pages. */
+static size_t
+mag_get (struct pool *p) {
+	struct magazine *mag = &p->mag;
+	enum intr_level old_level;
+	size_t page_idx = BITMAP_ERROR;
+
+	old_level = intr_disable ();
+	if (mag->cnt > 0) {
+		page_idx = mag->pages[--mag->cnt];
+		intr_set_level (old_level);
+		return page_idx;
+	}
+	intr_set_level (old_level);
+
+	/* Empty.  Refill while holding the lock, which also keeps
+	   other threads from refilling at the same time. */
+	lock_acquire (&p->lock);
+	old_level = intr_disable ();
+	while (mag->cnt < MAG_BATCH) {
+		size_t idx = pool_alloc (p, 1);
+		if (idx == BITMAP_ERROR)
+			break;
+		mag->pages[mag->cnt++] = idx;
+	}
+	if (mag->cnt > 0)
+		page_idx = mag->pages[--mag->cnt];
+	intr_set_level (old_level);
+	lock_release (&p->lock);
+	return page_idx;
+}
+
+/* Puts the page at PAGE_IDX into P's magazine, draining it first
+   if it is full. */
+static void
+mag_put (struct pool *p, size_t page_idx) {
+	struct magazine *mag = &p->mag;
+	enum intr_level old_level;
+
+	old_level = intr_disable ();
+	if (mag->cnt < MAG_SIZE) {
+		mag->pages[mag->cnt++] = page_idx;
+		intr_set_level (old_level);
+		return;
+	}
+	intr_set_level (old_level);
+
+	lock_acquire (&p->lock);
+	old_level = intr_disable ();
+	if (mag->cnt >= MAG_SIZE)
+		mag_drain (p, MAG_BATCH);
+	mag->pages[mag->cnt++] = page_idx;
+	intr_set_level (old_level);
+	lock_release (&p->lock);
+}
+
+/* Returns the CNT pages on top of P's magazine to the buddy
+   allocator.  P must be locked. */
+static void
+mag_drain (struct pool *p, int cnt) {
+	struct magazine *mag = &p->mag;
+	enum intr_level old_level = intr_disable ();
+
+	ASSERT (cnt <= mag->cnt);
+	while (cnt-- > 0)
+		pool_free (p, mag->pages[--mag->cnt], 1);
+	intr_set_level (old_level);
+}
+
+/* Takes a pre-zeroed page from P for a PAL_ZERO request for
+   PAGE_CNT pages.  Returns the page's index, or BITMAP_ERROR if
+   PAGE_CNT is not 1 or there is none.  Only single-page requests,
+   the only ones the zero pool can serve, count as a hit or a
+   miss. */
+static size_t
+zero_get (struct pool *p, size_t page_cnt) {
+	enum intr_level old_level;
+	size_t page_idx = BITMAP_ERROR;
+
+	if (page_cnt != 1)
+		return BITMAP_ERROR;
+
+	old_level = intr_disable ();
+	if (p->zero.cnt > 0) {
+		page_idx = p->zero.pages[--p->zero.cnt];
+		p->zero.hits++;
+	} else
+		p->zero.misses++;
+	intr_set_level (old_level);
+	return page_idx;
+}
+
+/* Returns P's pre-zeroed pages to the buddy allocator.  P must be
+   locked. */
+static void
+zero_drain (struct pool *p) {
+	enum intr_level old_level = intr_disable ();
 
-	*bm_base += bm_pages;
+	while (p->zero.cnt > 0)
+		pool_free (p, p->zero.pages[--p->zero.cnt], 1);
+	intr_set_level (old_level);
 }
 
 /* Returns true if PAGE was allocated from POOL,
@@ -353,6 +910,6 @@ static bool
 page_from_pool (const struct pool *pool, void *page) {
 	size_t page_no = pg_no (page);
 	size_t start_page = pg_no (pool->base);
-	size_t end_page = start_page + bitmap_size (pool->used_map);
+	size_t end_page = start_page + pool->page_cnt;
 	return page_no >= start_page && page_no < end_page;
 }
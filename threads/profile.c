@@ -0,0 +1,169 @@
+#include "threads/profile.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* Sampling CPU profiler, enabled with "-profile=N".
+
+   Every N-th timer tick, the timer interrupt hands its frame to
+   profile_tick(), which records the interrupted instruction and,
+   if it was in the kernel, the return addresses on the
+   frame-pointer chain above it.  User stacks are not walked,
+   since reading user memory could fault inside the interrupt.
+   Each distinct stack, per thread, has a slot in a fixed-size
+   open-addressing hash table that counts its samples; samples
+   that find the table full are only counted as dropped.
+
+   At shutdown the table is printed as "folded" stacks, one per
+   line, outermost caller first:
+
+     profile: main;0xffffffff8020a1b3;0xffffffff80209f41 17
+
+   Running the lines through "backtrace -f" replaces addresses
+   by function names, giving input for flamegraph.pl. */
+
+/* A sampled stack and its count. */
+struct profile_slot {
+	uint64_t cnt;                   /* Samples; 0 if slot unused. */
+	tid_t tid;                      /* Thread sampled. */
+	char name[16];                  /* Its name, when first sampled. */
+	int depth;                      /* Entries in pc[]. */
+	uintptr_t pc[PROFILE_DEPTH];    /* Innermost first. */
+};
+
+/* Is the profiler on? */
+bool profile_enabled;
+
+static int interval;            /* Ticks between samples. */
+static unsigned tick_cnt;       /* Ticks since the last sample. */
+
+static struct profile_slot slots[PROFILE_SLOTS];
+static int slot_cnt;            /* Slots in use. */
+static uint64_t sample_cnt;     /* Samples taken. */
+static uint64_t drop_cnt;       /* Samples dropped, table full. */
+
+/* Stop filling the table at this load factor, to keep probe
+   sequences short. */
+#define SLOTS_FULL (PROFILE_SLOTS / 4 * 3)
+
+/* Turns on the profiler, sampling every INTERVAL timer ticks. */
+void
+profile_init (int interval_) {
+	if (interval_ < 1)
+		PANIC ("profile interval must be at least 1 tick, not %d", interval_);
+	interval = interval_;
+	profile_enabled = true;
+}
+
+/* Returns a hash of thread TID's stack PC[], DEPTH entries. */
+static unsigned
+hash_stack (tid_t tid, const uintptr_t pc[], int depth) {
+	uint64_t h = 14695981039346656037ULL;   /* FNV-1a. */
+	int i;
+
+	h = (h ^ (uint64_t) tid) * 1099511628211ULL;
+	for (i = 0; i < depth; i++)
+		h = (h ^ pc[i]) * 1099511628211ULL;
+	return h ^ (h >> 32);
+}
+
+/* Counts one sample of thread T's stack PC[], DEPTH entries. */
+static void
+record (const struct thread *t, const uintptr_t pc[], int depth) {
+	unsigned i = hash_stack (t->tid, pc, depth) & (PROFILE_SLOTS - 1);
+
+	for (;; i = (i + 1) & (PROFILE_SLOTS - 1)) {
+		struct profile_slot *s = &slots[i];
+
+		if (s->cnt == 0) {
+			if (slot_cnt >= SLOTS_FULL) {
+				drop_cnt++;
+				return;
+			}
+			s->tid = t->tid;
+			strlcpy (s->name, t->name, sizeof s->name);
+			s->depth = depth;
+			memcpy (s->pc, pc, depth * sizeof *pc);
+			slot_cnt++;
+		} else if (s->tid != t->tid || s->depth != depth
+				|| memcmp (s->pc, pc, depth * sizeof *pc))
+			continue;
+		s->cnt++;
+		return;
+	}
+}
+
+/* Called by the timer interrupt on every tick with the frame F
+   of the code it interrupted.  Takes a sample every INTERVAL
+   ticks. */
+void
+profile_tick (const struct intr_frame *f) {
+	uintptr_t pc[PROFILE_DEPTH];
+	int depth = 0;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (++tick_cnt < (unsigned) interval)
+		return;
+	tick_cnt = 0;
+
+	pc[depth++] = f->rip;
+	if (is_kernel_vaddr (f->rip)) {
+		void **frame = (void **) f->R.rbp;
+
+		while (depth < PROFILE_DEPTH && frame != NULL
+				&& is_kernel_vaddr (frame) && frame[0] != NULL) {
+			pc[depth++] = (uintptr_t) frame[1];
+			frame = frame[0];
+		}
+	}
+	sample_cnt++;
+	record (thread_current (), pc, depth);
+}
+
+/* Returns the number of samples taken of thread TID, or of all
+   threads if TID is TID_ERROR. */
+uint64_t
+profile_samples (tid_t tid) {
+	enum intr_level old_level = intr_disable ();
+	uint64_t cnt = 0;
+	int i;
+
+	if (tid == TID_ERROR)
+		cnt = sample_cnt;
+	else
+		for (i = 0; i < PROFILE_SLOTS; i++)
+			if (slots[i].cnt != 0 && slots[i].tid == tid)
+				cnt += slots[i].cnt;
+	intr_set_level (old_level);
+	return cnt;
+}
+
+/* Prints the samples as folded stacks. */
+void
+profile_print_stats (void) {
+	int i, j;
+
+	if (!profile_enabled)
+		return;
+
+	/* Called at shutdown, so sampling the printing itself is
+	   not worth the trouble of copying the table. */
+	profile_enabled = false;
+
+	printf ("profile: %llu samples every %d ticks, %d stacks, %llu dropped\n",
+			(unsigned long long) sample_cnt, interval, slot_cnt,
+			(unsigned long long) drop_cnt);
+	for (i = 0; i < PROFILE_SLOTS; i++) {
+		const struct profile_slot *s = &slots[i];
+
+		if (s->cnt == 0)
+			continue;
+		printf ("profile: %s", s->name);
+		for (j = s->depth - 1; j >= 0; j--)
+			printf (";%#lx", (unsigned long) s->pc[j]);
+		printf (" %llu\n", (unsigned long long) s->cnt);
+	}
+}
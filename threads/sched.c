@@ -0,0 +1,172 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include "threads/interrupt.h"
+
+/* Scheduling classes other than the normal one, which lives in
+   thread.c next to the MLFQS code, plus the priority run queue
+   shared by the priority-based classes. */
+
+/* Initializes RQ to empty. */
+void
+prio_rq_init (struct prio_rq *rq) {
+	int i;
+
+	for (i = PRI_MIN; i <= PRI_MAX; i++)
+		list_init (&rq->queue[i]);
+	rq->bitmap = 0;
+	rq->cnt = 0;
+}
+
+/* Adds T to the back of its priority's queue in RQ. */
+void
+prio_rq_push (struct prio_rq *rq, struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (PRI_MIN <= t->priority && t->priority <= PRI_MAX);
+
+	list_push_back (&rq->queue[t->priority], &t->elem);
+	rq->bitmap |= 1ULL << t->priority;
+	rq->cnt++;
+}
+
+/* Removes and returns the frontmost thread of the highest
+   nonempty priority in RQ, which must not be empty. */
+struct thread *
+prio_rq_pop (struct prio_rq *rq) {
+	int priority = prio_rq_max (rq);
+	struct list *queue = &rq->queue[priority];
+	struct thread *t = list_entry (list_pop_front (queue), struct thread, elem);
+
+	if (list_empty (queue))
+		rq->bitmap &= ~(1ULL << priority);
+	rq->cnt--;
+	return t;
+}
+
+/* Removes ready thread T from RQ. */
+void
+prio_rq_remove (struct prio_rq *rq, struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->status == THREAD_READY);
+
+	list_remove (&t->elem);
+	if (list_empty (&rq->queue[t->priority]))
+		rq->bitmap &= ~(1ULL << t->priority);
+	rq->cnt--;
+}
+
+/* Returns the highest priority queued in RQ, which must not be
+   empty. */
+int
+prio_rq_max (const struct prio_rq *rq) {
+	ASSERT (rq->bitmap != 0);
+	return 63 - __builtin_clzll (rq->bitmap);
+}
+
+/* Real-time class: SCHED_FIFO and SCHED_RR.
+
+   Fixed priorities, never adjusted by the kernel except through
+   donation.  A FIFO thread runs until it blocks, yields or is
+   preempted by a higher priority; an RR thread additionally
+   yields at the end of each time slice. */
+
+static struct prio_rq rt_rq;
+
+static void
+rt_init (void) {
+	prio_rq_init (&rt_rq);
+}
+
+static void
+rt_enqueue (struct thread *t) {
+	prio_rq_push (&rt_rq, t);
+}
+
+static void
+rt_dequeue (struct thread *t) {
+	prio_rq_remove (&rt_rq, t);
+}
+
+static struct thread *
+rt_pick_next (void) {
+	return rt_rq.cnt != 0 ? prio_rq_pop (&rt_rq) : NULL;
+}
+
+static bool
+rt_tick (struct thread *curr, unsigned ran) {
+	return curr->policy == SCHED_RR && ran >= TIME_SLICE;
+}
+
+static bool
+rt_preempt_check (struct thread *curr) {
+	if (rt_rq.cnt == 0)
+		return false;
+	if (curr->sched_class != &rt_sched_class)
+		return true;
+	return prio_rq_max (&rt_rq) > curr->priority;
+}
+
+const struct sched_class rt_sched_class = {
+	.name = "rt",
+	.rank = SCHED_RANK_RT,
+	.priority_donation = true,
+	.init = rt_init,
+	.enqueue = rt_enqueue,
+	.dequeue = rt_dequeue,
+	.pick_next = rt_pick_next,
+	.tick = rt_tick,
+	.yield = rt_enqueue,
+	.preempt_check = rt_preempt_check,
+};
+
+/* Idle class: SCHED_IDLE.
+
+   For background work such as page zeroing and writeback.
+   Threads run round-robin, ignoring priority, and only when no
+   thread of any other class is ready. */
+
+static struct list idle_rq;
+
+static void
+idle_init (void) {
+	list_init (&idle_rq);
+}
+
+static void
+idle_enqueue (struct thread *t) {
+	list_push_back (&idle_rq, &t->elem);
+}
+
+static void
+idle_dequeue (struct thread *t) {
+	list_remove (&t->elem);
+}
+
+static struct thread *
+idle_pick_next (void) {
+	if (list_empty (&idle_rq))
+		return NULL;
+	return list_entry (list_pop_front (&idle_rq), struct thread, elem);
+}
+
+static bool
+idle_tick (struct thread *curr UNUSED, unsigned ran) {
+	return ran >= TIME_SLICE;
+}
+
+static bool
+idle_preempt_check (struct thread *curr) {
+	return !list_empty (&idle_rq) && curr->sched_class != &idle_sched_class;
+}
+
+const struct sched_class idle_sched_class = {
+	.name = "idle",
+	.rank = SCHED_RANK_IDLE,
+	.priority_donation = false,
+	.init = idle_init,
+	.enqueue = idle_enqueue,
+	.dequeue = idle_dequeue,
+	.pick_next = idle_pick_next,
+	.tick = idle_tick,
+	.yield = idle_enqueue,
+	.preempt_check = idle_preempt_check,
+};
@@ -0,0 +1,200 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <rbtree.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+
+/* Earliest-deadline-first class: SCHED_DEADLINE.
+
+   A thread reserves RUNTIME ticks of CPU time in every PERIOD
+   ticks, to be delivered within DEADLINE ticks of the start of
+   each period, with thread_set_deadline().  Admission control
+   keeps the total utilization, the sum of RUNTIME / PERIOD over
+   all deadline threads, within sched_dl_bw_limit, so that every
+   reservation can be met.  Ready threads are kept in a red-black
+   tree ordered by absolute deadline, and the earliest runs.
+
+   Budgets follow the constant bandwidth server rules.  Each tick
+   a running thread consumes one tick of its budget, and when the
+   budget runs out the thread is throttled: it blocks until the
+   start of its next period, which replenishes the budget and
+   moves the deadline one period ahead.  A thread that wakes up
+   gets a fresh budget and deadline if its old ones would let it
+   use more than its reserved bandwidth.
+
+   Deadline threads outrank every other class.  Priority donation
+   is not done, neither to nor from them. */
+
+/* Percentage of the CPU that deadline threads may reserve in
+   total.  Controlled by kernel command-line option
+   "-dl-bw=PERCENT". */
+int sched_dl_bw_limit = 95;
+
+/* Bandwidths are fixed-point fractions of the CPU with this many
+   fraction bits. */
+#define BW_SHIFT 20
+
+static struct rbtree dl_rq;     /* Ready threads by deadline. */
+static int64_t total_bw;        /* Bandwidth reserved so far. */
+
+static int64_t
+to_bw (int64_t runtime, int64_t period) {
+	return (runtime << BW_SHIFT) / period;
+}
+
+static bool
+deadline_less (const struct rb_elem *a_, const struct rb_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = rb_entry (a_, struct thread, rb_elem);
+	const struct thread *b = rb_entry (b_, struct thread, rb_elem);
+
+	return a->dl_abs_deadline < b->dl_abs_deadline;
+}
+
+static struct thread *
+leftmost (void) {
+	struct rb_elem *e = rb_min (&dl_rq);
+	return e != NULL ? rb_entry (e, struct thread, rb_elem) : NULL;
+}
+
+/* Starts a new period for T at tick NOW. */
+static void
+replenish (struct thread *t, int64_t now) {
+	t->dl_abs_deadline = now + t->dl_deadline;
+	t->dl_budget = t->dl_runtime;
+}
+
+static bool dl_preempt_check (struct thread *curr);
+
+/* Timer callback that wakes up throttled thread T_ at the start
+   of its next period.  Enqueuing it replenishes its budget. */
+static void
+unthrottle (void *t_) {
+	struct thread *t = t_;
+
+	t->dl_throttled = false;
+	thread_unblock (t);
+	if (intr_context () && dl_preempt_check (thread_current ()))
+		intr_yield_on_return ();
+}
+
+/* Reserves RUNTIME ticks in every PERIOD, within DEADLINE ticks
+   of the period's start, for thread T, replacing T's existing
+   reservation if it is already a deadline thread, and starts
+   T's first period.  Returns false, without changing anything,
+   if the parameters are invalid or if the reservation would
+   raise the total above sched_dl_bw_limit.
+
+   The caller must move T into dl_sched_class afterward, with T
+   off any run queue and interrupts off. */
+bool
+sched_dl_admit (struct thread *t, int64_t runtime, int64_t deadline,
+		int64_t period) {
+	int64_t old_bw = 0;
+	int64_t new_bw;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (runtime <= 0 || runtime > deadline || deadline > period)
+		return false;
+	new_bw = to_bw (runtime, period);
+	if (t->sched_class == &dl_sched_class)
+		old_bw = to_bw (t->dl_runtime, t->dl_period);
+	if (total_bw - old_bw + new_bw > to_bw (sched_dl_bw_limit, 100))
+		return false;
+	total_bw += new_bw - old_bw;
+
+	t->dl_runtime = runtime;
+	t->dl_deadline = deadline;
+	t->dl_period = period;
+	if (!t->dl_timer.pending)
+		timer_event_init (&t->dl_timer, unthrottle, t);
+	replenish (t, timer_ticks ());
+	return true;
+}
+
+static void
+dl_init (void) {
+	rb_init (&dl_rq, deadline_less, NULL);
+	total_bw = 0;
+}
+
+static void
+dl_enqueue (struct thread *t) {
+	/* Constant bandwidth server wakeup rule: keep the current
+	   deadline only if the remaining budget, spread over the
+	   time left until it, fits within the reserved bandwidth. */
+	if (t->status == THREAD_BLOCKED) {
+		int64_t now = timer_ticks ();
+
+		if (now >= t->dl_abs_deadline
+				|| t->dl_budget * t->dl_period
+				> (t->dl_abs_deadline - now) * t->dl_runtime)
+			replenish (t, now);
+	}
+	rb_insert (&dl_rq, &t->rb_elem);
+}
+
+static void
+dl_dequeue (struct thread *t) {
+	rb_remove (&dl_rq, &t->rb_elem);
+}
+
+static struct thread *
+dl_pick_next (void) {
+	struct thread *t = leftmost ();
+
+	if (t != NULL)
+		dl_dequeue (t);
+	return t;
+}
+
+static bool
+dl_tick (struct thread *curr, unsigned ran UNUSED) {
+	int64_t release, now;
+
+	if (--curr->dl_budget > 0)
+		return false;
+
+	/* Out of budget: throttle until the next period starts.
+	   thread_yield() blocks throttled threads. */
+	now = timer_ticks ();
+	release = curr->dl_abs_deadline - curr->dl_deadline + curr->dl_period;
+	if (release <= now)
+		release = now + 1;
+	curr->dl_throttled = true;
+	timer_add (&curr->dl_timer, release);
+	return true;
+}
+
+static bool
+dl_preempt_check (struct thread *curr) {
+	struct thread *first = leftmost ();
+
+	if (first == NULL)
+		return false;
+	if (curr->sched_class != &dl_sched_class)
+		return true;
+	return first->dl_abs_deadline < curr->dl_abs_deadline;
+}
+
+/* Returns T's bandwidth to the pool.  If T is throttled, its
+   timer still wakes it up, into its new class. */
+static void
+dl_detach (struct thread *t) {
+	total_bw -= to_bw (t->dl_runtime, t->dl_period);
+}
+
+const struct sched_class dl_sched_class = {
+	.name = "deadline",
+	.rank = SCHED_RANK_DL,
+	.priority_donation = false,
+	.init = dl_init,
+	.enqueue = dl_enqueue,
+	.dequeue = dl_dequeue,
+	.pick_next = dl_pick_next,
+	.tick = dl_tick,
+	.yield = dl_enqueue,
+	.preempt_check = dl_preempt_check,
+	.detach = dl_detach,
+};
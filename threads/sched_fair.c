@@ -0,0 +1,201 @@
+#include "threads/sched.h"
+#include <debug.h>
+#include <rbtree.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+
+/* Completely fair scheduling class, selected with -sched=cfs.
+
+   Replaces the normal class.  Each thread accumulates virtual
+   runtime at a rate inversely proportional to its weight, which
+   is derived from its nice value, and the thread with the least
+   virtual runtime runs next.  Ready threads are kept in a
+   red-black tree ordered by virtual runtime.
+
+   Instead of a fixed TIME_SLICE, every runnable thread should
+   run once per SCHED_LATENCY ticks, so a thread's slice is its
+   share of that period by weight, but never less than
+   SCHED_MIN_GRANULARITY.  Priorities are ignored, and so is
+   priority donation. */
+
+/* Weight of a nice-0 thread. */
+#define NICE_0_WEIGHT 1024
+
+/* Target period, in timer ticks, in which every runnable thread
+   runs once. */
+#define SCHED_LATENCY 8
+
+/* Minimum slice, in timer ticks. */
+#define SCHED_MIN_GRANULARITY 1
+
+/* Virtual runtime a nice-0 thread accumulates per tick.  The
+   unit is the microsecond. */
+#define VRUNTIME_PER_TICK ((int64_t) 1000000 / TIMER_FREQ)
+
+/* How far behind a woken thread may place itself, so that
+   sleepers get some credit without starving the others. */
+#define SLEEPER_CREDIT (SCHED_LATENCY * VRUNTIME_PER_TICK / 2)
+
+/* A thread that woke up preempts the running thread only if
+   it is at least this far behind, to avoid overscheduling. */
+#define WAKEUP_GRANULARITY VRUNTIME_PER_TICK
+
+/* Weights for nice values -20...20.  Each step is about 1.25x,
+   so that one nice level is worth about 10% of the CPU.  The
+   first 40 entries match Linux's sched_prio_to_weight[]. */
+static const int nice_to_weight[NICE_MAX - NICE_MIN + 1] = {
+	/* -20 */ 88761, 71755, 56483, 46273, 36291,
+	/* -15 */ 29154, 23254, 18705, 14949, 11916,
+	/* -10 */ 9548, 7620, 6100, 4904, 3906,
+	/*  -5 */ 3121, 2501, 1991, 1586, 1277,
+	/*   0 */ 1024, 820, 655, 526, 423,
+	/*   5 */ 335, 272, 215, 172, 137,
+	/*  10 */ 110, 87, 70, 56, 45,
+	/*  15 */ 36, 29, 23, 18, 15,
+	/*  20 */ 12,
+};
+
+static struct rbtree fair_rq;   /* Ready threads by vruntime. */
+static int64_t total_weight;    /* Sum of weights in fair_rq. */
+static int64_t min_vruntime;    /* Monotonic floor of vruntimes. */
+
+static int
+weight (const struct thread *t) {
+	ASSERT (NICE_MIN <= t->nice && t->nice <= NICE_MAX);
+	return nice_to_weight[t->nice - NICE_MIN];
+}
+
+static struct thread *
+leftmost (void) {
+	struct rb_elem *e = rb_min (&fair_rq);
+	return e != NULL ? rb_entry (e, struct thread, rb_elem) : NULL;
+}
+
+static bool
+vruntime_less (const struct rb_elem *a_, const struct rb_elem *b_,
+		void *aux UNUSED) {
+	const struct thread *a = rb_entry (a_, struct thread, rb_elem);
+	const struct thread *b = rb_entry (b_, struct thread, rb_elem);
+
+	return a->vruntime < b->vruntime;
+}
+
+/* Advances min_vruntime to the least vruntime among CURR, if it
+   is a thread of this class, and the ready threads. */
+static void
+update_min_vruntime (struct thread *curr) {
+	struct thread *first = leftmost ();
+	int64_t vruntime;
+
+	if (curr != NULL && curr->sched_class == &fair_sched_class) {
+		vruntime = curr->vruntime;
+		if (first != NULL && first->vruntime < vruntime)
+			vruntime = first->vruntime;
+	} else if (first != NULL)
+		vruntime = first->vruntime;
+	else
+		return;
+
+	if (vruntime > min_vruntime)
+		min_vruntime = vruntime;
+}
+
+/* Returns the slice, in ticks, of running thread CURR. */
+static unsigned
+slice (const struct thread *curr) {
+	int64_t w = weight (curr);
+	int64_t nr_running = rb_size (&fair_rq) + 1;
+	int64_t period = SCHED_LATENCY;
+	int64_t ticks;
+
+	if (nr_running * SCHED_MIN_GRANULARITY > period)
+		period = nr_running * SCHED_MIN_GRANULARITY;
+	ticks = period * w / (total_weight + w);
+	return ticks < SCHED_MIN_GRANULARITY ? SCHED_MIN_GRANULARITY : ticks;
+}
+
+static void
+fair_init (void) {
+	rb_init (&fair_rq, vruntime_less, NULL);
+	total_weight = 0;
+	min_vruntime = 0;
+}
+
+static void
+fair_enqueue (struct thread *t) {
+	/* A new or waking thread starts no further back than a
+	   little behind the others, so that it cannot claim all the
+	   CPU time it missed while blocked. */
+	if (t->status == THREAD_BLOCKED
+			&& t->vruntime < min_vruntime - SLEEPER_CREDIT)
+		t->vruntime = min_vruntime - SLEEPER_CREDIT;
+
+	rb_insert (&fair_rq, &t->rb_elem);
+	total_weight += weight (t);
+}
+
+/* A thread leaving the class keeps its vruntime relative to
+   min_vruntime, which moves on without it. */
+static void
+fair_detach (struct thread *t) {
+	t->vruntime -= min_vruntime;
+}
+
+/* A thread joining the class, for example back from the RT or
+   deadline class, resumes at the same distance ahead of
+   min_vruntime, but never behind it, so that it cannot hold the
+   CPU while it catches up with time it spent elsewhere. */
+static void
+fair_attach (struct thread *t) {
+	t->vruntime = t->vruntime > 0 ? min_vruntime + t->vruntime : min_vruntime;
+}
+
+static void
+fair_dequeue (struct thread *t) {
+	rb_remove (&fair_rq, &t->rb_elem);
+	total_weight -= weight (t);
+}
+
+static struct thread *
+fair_pick_next (void) {
+	struct thread *t = leftmost ();
+
+	if (t != NULL) {
+		fair_dequeue (t);
+		update_min_vruntime (t);
+	}
+	return t;
+}
+
+static bool
+fair_tick (struct thread *curr, unsigned ran) {
+	curr->vruntime += VRUNTIME_PER_TICK * NICE_0_WEIGHT / weight (curr);
+	update_min_vruntime (curr);
+	return ran >= slice (curr);
+}
+
+static bool
+fair_preempt_check (struct thread *curr) {
+	struct thread *first = leftmost ();
+
+	if (first == NULL)
+		return false;
+	if (curr->sched_class != &fair_sched_class)
+		return true;
+	return first->vruntime + WAKEUP_GRANULARITY < curr->vruntime;
+}
+
+const struct sched_class fair_sched_class = {
+	.name = "cfs",
+	.rank = SCHED_RANK_NORMAL,
+	.priority_donation = false,
+	.init = fair_init,
+	.enqueue = fair_enqueue,
+	.dequeue = fair_dequeue,
+	.pick_next = fair_pick_next,
+	.tick = fair_tick,
+	.yield = fair_enqueue,
+	.preempt_check = fair_preempt_check,
+	.detach = fair_detach,
+	.attach = fair_attach,
+};
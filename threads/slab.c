@@ -0,0 +1,267 @@
+#include "threads/slab.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/malloc.h"
+#include "threads/interrupt.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+
+/* Slab allocator for fixed-size objects, after Bonwick, "The
+   Slab Allocator: An Object-Caching Kernel Memory Allocator".
+
+   A cache hands out objects of one size, packed without rounding
+   to a power of 2 into one-page "slabs".  Each slab starts with
+   a header, followed by a stack of the indexes of its free
+   objects, then the objects themselves.  A cache keeps its slabs
+   on three lists: full, partial and empty.  Objects come from a
+   partial slab if there is one, otherwise from an empty slab,
+   and only otherwise from a new page.  At most one empty slab
+   is kept; the pages of any others go back to the page
+   allocator.
+
+   If the cache has a constructor, it runs once per object when
+   the slab is created, not on every allocation, so objects must
+   be returned to the cache in their constructed state.
+
+   The space left over at the end of a slab is used to "colour"
+   slabs: each new slab starts its objects one colour unit, a
+   cache line or the alignment if larger, further in than the
+   last, wrapping around, so that objects at the same index in
+   different slabs do not all compete for the same cache sets. */
+
+/* Magic number for detecting slab corruption. */
+#define SLAB_MAGIC 0x51ab51ab
+
+/* Colour unit, the size of a cache line. */
+#define CACHE_LINE 64
+
+/* An object cache. */
+struct kmem_cache {
+	char name[16];              /* For statistics. */
+	size_t size;                /* Object size. */
+	size_t stride;              /* Distance between objects. */
+	size_t obj_ofs;             /* Offset of uncoloured first object. */
+	unsigned obj_cnt;           /* Objects per slab. */
+	kmem_ctor_func *ctor;       /* Constructor, or null. */
+
+	size_t colour_unit;         /* Bytes per colour. */
+	unsigned colour_cnt;        /* Number of colours. */
+	unsigned colour_next;       /* Colour of the next slab. */
+
+	struct lock lock;           /* Protects the slab lists. */
+	struct list full;           /* Slabs with no free objects. */
+	struct list partial;        /* Slabs with some free objects. */
+	struct list empty;          /* Slabs with no objects in use. */
+
+	/* Statistics. */
+	unsigned slab_cnt;          /* Slabs allocated now. */
+	unsigned inuse_cnt;         /* Objects allocated now. */
+	unsigned inuse_max;         /* Most objects allocated at once. */
+	unsigned long long alloc_cnt;   /* Calls to kmem_cache_alloc(). */
+
+	struct list_elem elem;      /* In all_caches. */
+};
+
+/* Slab header, at the start of its page. */
+struct slab {
+	unsigned magic;             /* Always set to SLAB_MAGIC. */
+	struct kmem_cache *cache;   /* Owning cache. */
+	struct list_elem elem;      /* In a list of the cache. */
+	uint8_t *objs;              /* First object. */
+	unsigned free_cnt;          /* Number of free objects. */
+	uint16_t free[];            /* Free object indexes; top last. */
+};
+
+/* All caches, for kmem_print_stats().  Protected by turning
+   off interrupts. */
+static struct list all_caches;
+
+/* Initializes the slab allocator. */
+void
+kmem_init (void) {
+	list_init (&all_caches);
+}
+
+/* Returns the offset in a slab of the first object of a cache
+   whose slabs hold OBJ_CNT objects aligned to ALIGN. */
+static size_t
+first_obj_ofs (unsigned obj_cnt, size_t align) {
+	return ROUND_UP (sizeof (struct slab) + obj_cnt * sizeof (uint16_t), align);
+}
+
+/* Creates and returns a cache, called NAME, of objects of SIZE
+   bytes aligned to ALIGN bytes, a power of 2, or to the natural
+   word size if ALIGN is 0.  If CTOR is nonnull, it is run on
+   each object once when its slab is created.  Returns a null
+   pointer if memory is not available. */
+struct kmem_cache *
+kmem_cache_create (const char *name, size_t size, size_t align,
+		kmem_ctor_func *ctor) {
+	struct kmem_cache *c;
+	enum intr_level old_level;
+	unsigned obj_cnt;
+	size_t left;
+
+	if (align == 0)
+		align = sizeof (void *);
+	ASSERT ((align & (align - 1)) == 0);
+	ASSERT (size > 0);
+
+	c = malloc (sizeof *c);
+	if (c == NULL)
+		return NULL;
+
+	strlcpy (c->name, name, sizeof c->name);
+	c->size = size;
+	c->stride = ROUND_UP (size, align);
+	c->ctor = ctor;
+
+	/* Fit as many objects into a page as the header and its
+	   stack of free indexes leave room for. */
+	obj_cnt = (PGSIZE - sizeof (struct slab)) / (c->stride + sizeof (uint16_t));
+	while (obj_cnt > 0
+			&& first_obj_ofs (obj_cnt, align) + obj_cnt * c->stride > PGSIZE)
+		obj_cnt--;
+	if (obj_cnt == 0)
+		PANIC ("kmem_cache_create: %zu-byte objects of `%s' do not fit in a slab",
+				size, name);
+	c->obj_cnt = obj_cnt;
+	c->obj_ofs = first_obj_ofs (obj_cnt, align);
+
+	left = PGSIZE - c->obj_ofs - obj_cnt * c->stride;
+	c->colour_unit = align > CACHE_LINE ? align : CACHE_LINE;
+	c->colour_cnt = left / c->colour_unit + 1;
+	c->colour_next = 0;
+
+	lock_init (&c->lock);
+	list_init (&c->full);
+	list_init (&c->partial);
+	list_init (&c->empty);
+	c->slab_cnt = c->inuse_cnt = c->inuse_max = 0;
+	c->alloc_cnt = 0;
+
+	old_level = intr_disable ();
+	list_push_back (&all_caches, &c->elem);
+	intr_set_level (old_level);
+	return c;
+}
+
+/* Returns a new slab for cache C, with every object free and
+   constructed, or a null pointer if memory is not available. */
+static struct slab *
+slab_create (struct kmem_cache *c) {
+	struct slab *s = palloc_get_page (0);
+	unsigned i;
+
+	if (s == NULL)
+		return NULL;
+
+	s->magic = SLAB_MAGIC;
+	s->cache = c;
+	s->objs = (uint8_t *) s + c->obj_ofs + c->colour_next * c->colour_unit;
+	c->colour_next = (c->colour_next + 1) % c->colour_cnt;
+
+	/* Hand out the lowest addresses first. */
+	s->free_cnt = c->obj_cnt;
+	for (i = 0; i < c->obj_cnt; i++) {
+		s->free[i] = c->obj_cnt - 1 - i;
+		if (c->ctor != NULL)
+			c->ctor (s->objs + i * c->stride);
+	}
+	c->slab_cnt++;
+	return s;
+}
+
+/* Allocates and returns an object from cache C, or a null
+   pointer if memory is not available. */
+void *
+kmem_cache_alloc (struct kmem_cache *c) {
+	struct slab *s;
+	void *obj;
+
+	lock_acquire (&c->lock);
+	if (!list_empty (&c->partial))
+		s = list_entry (list_pop_front (&c->partial), struct slab, elem);
+	else if (!list_empty (&c->empty))
+		s = list_entry (list_pop_front (&c->empty), struct slab, elem);
+	else {
+		s = slab_create (c);
+		if (s == NULL) {
+			lock_release (&c->lock);
+			return NULL;
+		}
+	}
+
+	obj = s->objs + s->free[--s->free_cnt] * c->stride;
+	list_push_front (s->free_cnt > 0 ? &c->partial : &c->full, &s->elem);
+
+	c->alloc_cnt++;
+	if (++c->inuse_cnt > c->inuse_max)
+		c->inuse_max = c->inuse_cnt;
+	lock_release (&c->lock);
+	return obj;
+}
+
+/* Returns OBJ, which must have come from kmem_cache_alloc(C), to
+   cache C. */
+void
+kmem_cache_free (struct kmem_cache *c, void *obj) {
+	struct slab *s;
+	size_t ofs;
+
+	if (obj == NULL)
+		return;
+
+	s = pg_round_down (obj);
+	ASSERT (s->magic == SLAB_MAGIC);
+	ASSERT (s->cache == c);
+	ofs = (uint8_t *) obj - s->objs;
+	ASSERT (ofs % c->stride == 0 && ofs / c->stride < c->obj_cnt);
+
+#ifndef NDEBUG
+	/* Clear the object to help detect use-after-free bugs, unless
+	   it must keep its constructed state. */
+	if (c->ctor == NULL)
+		memset (obj, 0xcc, c->size);
+#endif
+
+	lock_acquire (&c->lock);
+	s->free[s->free_cnt++] = ofs / c->stride;
+	c->inuse_cnt--;
+	list_remove (&s->elem);
+	if (s->free_cnt < c->obj_cnt)
+		list_push_front (&c->partial, &s->elem);
+	else if (list_empty (&c->empty))
+		list_push_front (&c->empty, &s->elem);
+	else {
+		s->magic = 0;
+		c->slab_cnt--;
+		palloc_free_page (s);
+	}
+	lock_release (&c->lock);
+}
+
+/* Prints statistics for every cache.  Called at shutdown, maybe
+   on a panic, so it takes no locks and the counts may be a
+   little stale. */
+void
+kmem_print_stats (void) {
+	struct list_elem *e;
+
+	if (!list_empty (&all_caches))
+		printf ("kmem: cache            size  objs/slab  slabs  inuse    max"
+				"     allocs\n");
+	for (e = list_begin (&all_caches); e != list_end (&all_caches);
+			e = list_next (e)) {
+		struct kmem_cache *c = list_entry (e, struct kmem_cache, elem);
+
+		printf ("kmem: %-15s %5zu  %9u  %5u  %5u  %5u  %9llu\n",
+				c->name, c->size, c->obj_cnt, c->slab_cnt, c->inuse_cnt,
+				c->inuse_max, c->alloc_cnt);
+	}
+}
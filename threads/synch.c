@@ -22,13 +22,223 @@
    */
 
 #include "threads/synch.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
+#include "threads/sched.h"
 #include "threads/thread.h"
+#include "intrinsic.h"
 
 
-static bool sema_compare_priority(const struct list_elem *higher, const struct list_elem *lower, void *aux UNUSED);
+/* Converts pointer to wait queue node E into a pointer to the
+   thread it is embedded in. */
+#define waitq_entry(E) \
+	((struct thread *) ((uint8_t *) (E) - offsetof (struct thread, w_elem)))
+
+/* Arrival counter, so that equal threads leave in FIFO order. */
+static uint64_t waitq_seq;
+
+/* Initializes wait queue Q to empty. */
+void
+waitq_init (struct waitq *q) {
+	ASSERT (q != NULL);
+	q->root = NULL;
+}
+
+/* Returns true if Q has no threads. */
+bool
+waitq_empty (const struct waitq *q) {
+	return q->root == NULL;
+}
+
+/* Returns true if the thread of node A should be woken before
+   that of node B. */
+static bool
+waitq_before (const struct waitq_elem *a, const struct waitq_elem *b) {
+	const struct thread *ta = waitq_entry (a);
+	const struct thread *tb = waitq_entry (b);
+
+	//PDG 클래스가 다르면 rank가 낮은(먼저 실행되는) 클래스 우선
+	if (ta->sched_class->rank != tb->sched_class->rank)
+		return ta->sched_class->rank < tb->sched_class->rank;
+	if (ta->priority != tb->priority)
+		return ta->priority > tb->priority;
+	return a->seq < b->seq;
+}
+
+/* Melds heaps A and B, either of which may be empty, into one
+   and returns its root.  A and B must have no siblings. */
+static struct waitq_elem *
+waitq_meld (struct waitq_elem *a, struct waitq_elem *b) {
+	struct waitq_elem *tmp;
+
+	if (a == NULL)
+		return b;
+	if (b == NULL)
+		return a;
+	if (waitq_before (b, a)) {
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	/* Make B the first child of A. */
+	b->prev = a;
+	b->next = a->child;
+	if (a->child != NULL)
+		a->child->prev = b;
+	a->child = b;
+	return a;
+}
+
+/* Melds the list of sibling heaps starting at FIRST into one
+   heap and returns its root, using the two-pass method that gives
+   pairing heaps their amortized bounds: meld pairs from left to
+   right, then meld the results from right to left. */
+static struct waitq_elem *
+waitq_merge_pairs (struct waitq_elem *first) {
+	struct waitq_elem *pairs = NULL;
+	struct waitq_elem *root = NULL;
+
+	while (first != NULL) {
+		struct waitq_elem *a = first;
+		struct waitq_elem *b = a->next;
+
+		first = b != NULL ? b->next : NULL;
+		a->next = a->prev = NULL;
+		if (b != NULL)
+			b->next = b->prev = NULL;
+		a = waitq_meld (a, b);
+		a->next = pairs;
+		pairs = a;
+	}
+	while (pairs != NULL) {
+		struct waitq_elem *a = pairs;
+
+		pairs = a->next;
+		a->next = NULL;
+		root = waitq_meld (root, a);
+	}
+	return root;
+}
+
+/* Adds T to Q, keeping the arrival order in T's node. */
+static void
+waitq_insert (struct waitq *q, struct thread *t) {
+	struct waitq_elem *e = &t->w_elem;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (t->waitq == NULL);
+
+	e->child = e->next = e->prev = NULL;
+	q->root = waitq_meld (q->root, e);
+	t->waitq = q;
+}
+
+/* Adds T to the back of its equals in Q. */
+static void
+waitq_push (struct waitq *q, struct thread *t) {
+	t->w_elem.seq = waitq_seq++;
+	waitq_insert (q, t);
+}
+
+/* Returns the first thread in Q, which must not be empty,
+   without removing it. */
+static struct thread *
+waitq_front (const struct waitq *q) {
+	ASSERT (!waitq_empty (q));
+	return waitq_entry (q->root);
+}
+
+/* Removes T from the wait queue it is in. */
+static void
+waitq_remove (struct thread *t) {
+	struct waitq *q = t->waitq;
+	struct waitq_elem *e = &t->w_elem;
+	struct waitq_elem *sub;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	ASSERT (q != NULL);
+
+	/* Unlink E from its parent and siblings, unless it is the
+	   root, then meld its children back in. */
+	if (e != q->root) {
+		if (e->prev->child == e)
+			e->prev->child = e->next;
+		else
+			e->prev->next = e->next;
+		if (e->next != NULL)
+			e->next->prev = e->prev;
+	}
+	sub = waitq_merge_pairs (e->child);
+	q->root = waitq_meld (e != q->root ? q->root : NULL, sub);
+	e->child = e->next = e->prev = NULL;
+	t->waitq = NULL;
+}
+
+/* Removes and returns the first thread in Q, which must not be
+   empty. */
+static struct thread *
+waitq_pop (struct waitq *q) {
+	struct thread *t = waitq_front (q);
+
+	waitq_remove (t);
+	return t;
+}
+
+/* Moves T to its new place in its wait queue after a change to
+   its priority or scheduling class.  T keeps its arrival order
+   among threads that compare equal. */
+void
+waitq_requeue (struct thread *t) {
+	struct waitq *q = t->waitq;
+
+	ASSERT (q != NULL);
+
+	waitq_remove (t);
+	waitq_insert (q, t);
+}
+
+/* PDG 타임아웃 대기. 대기 큐에 있는 스레드를 이벤트(큐에서 꺼내 깨움)와
+   타이머 중 먼저 온 쪽이 깨움. 둘 다 인터럽트가 꺼진 채로 실행되므로
+   먼저 온 쪽이 스레드를 큐에서 빼고, 나중에 온 쪽은 큐에 없는 걸 보고
+   깨우지 않음. 다만 만료 표시는 항상 남김: 이벤트에 깨워진 스레드가
+   실행되기 전에 다른 스레드가 값을 가져가면 다시 기다려야 하는데,
+   그때 타이머는 이미 지나갔으므로 expired를 보고 멈춰야 함 */
+struct wait_timeout {
+	struct timer_event event;   /* 만료 타이머 */
+	struct thread *thread;      /* 대기하는 스레드 */
+	bool expired;               /* 타이머가 만료됐으면 true */
+	bool woke;                  /* 타이머가 큐에서 빼서 깨웠으면 true */
+};
+
+/* PDG 타임아웃 타이머 만료 콜백, 타이머 인터럽트 안에서 실행.
+   만료는 항상 표시하고, 스레드가 아직 대기 큐에 있을 때만 빼서 깨움 */
+static void
+wait_timeout_expired (void *to_) {
+	struct wait_timeout *to = to_;
+	struct thread *t = to->thread;
+
+	to->expired = true;
+	if (t->waitq == NULL)
+		return;
+	waitq_remove (t);
+	to->woke = true;
+	thread_wake (t);
+}
+
+/* PDG 현재 스레드에 TICKS 틱 뒤 만료되는 타임아웃 TO를 설정 */
+static void
+wait_timeout_start (struct wait_timeout *to, int64_t ticks) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	to->thread = thread_current ();
+	to->expired = false;
+	to->woke = false;
+	timer_event_init (&to->event, wait_timeout_expired, to);
+	timer_add (&to->event, timer_ticks () + ticks);
+}
 
 /* 세마포어 SEMA를 VALUE로 초기화합니다. 세마포어는
    두 가지 원자적 연산과 함께 사용하는 비음수 정수입니다:
@@ -43,7 +253,7 @@ sema_init (struct semaphore *sema, unsigned value) {
 	ASSERT (sema != NULL);
 
 	sema->value = value;
-	list_init (&sema->waiters);
+	waitq_init (&sema->waiters);
 }
 
 /* 세마포어에서 down 또는 "P" 연산. SEMA의 값이 양수가 될 때까지 기다린 후
@@ -62,16 +272,44 @@ sema_down (struct semaphore *sema) {
 
 	old_level = intr_disable ();
 	while (sema->value == 0) {
-		//PDG 대기리스트 정렬 insert로 변경
-		//PDG 대기리스트 정렬 insert로 변경
-		list_insert_ordered (&sema->waiters, &thread_current ()->elem, compare_priority, NULL);
-		//list_push_back (&sema->waiters, &thread_current ()->elem);
+		//PDG 대기 큐(우선순위 힙)에 넣고 block
+		waitq_push (&sema->waiters, thread_current ());
 		thread_block ();
 	}
 	sema->value--;
 	intr_set_level (old_level);
 }
 
+/* PDG 최대 TICKS 틱 동안만 기다리는 sema_down().
+   SEMA를 down 했으면 true, 시간이 다 되었으면 false 반환.
+   TICKS가 0 이하면 sema_try_down()과 같음.
+   시간이 다 된 뒤라도 깨어났을 때 값이 양수면 down 하고 true */
+bool
+sema_down_timeout (struct semaphore *sema, int64_t ticks) {
+	struct wait_timeout to;
+	enum intr_level old_level;
+	bool success;
+
+	ASSERT (sema != NULL);
+	ASSERT (!intr_context ());
+
+	if (ticks <= 0)
+		return sema_try_down (sema);
+
+	old_level = intr_disable ();
+	wait_timeout_start (&to, ticks);
+	while (sema->value == 0 && !to.expired) {
+		waitq_push (&sema->waiters, thread_current ());
+		thread_block ();
+	}
+	timer_cancel (&to.event);
+	success = sema->value > 0;
+	if (success)
+		sema->value--;
+	intr_set_level (old_level);
+	return success;
+}
+
 /* 세마포어에서 down 또는 "P" 연산을 수행하지만,
    세마포어가 이미 0이 아닌 경우에만 수행합니다.
    세마포어가 감소되면 true를 반환하고, 그렇지 않으면 false를 반환합니다.
@@ -97,6 +335,17 @@ sema_try_down (struct semaphore *sema) {
 	return success;
 }
 
+/* PDG sema_up()에서 선점 검사를 뺀 부분. 인터럽트가 꺼진 상태에서 호출 */
+static void
+sema_up_locked (struct semaphore *sema) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	/*PDG 대기 큐 맨 앞(가장 높은 우선순위) 스레드를 깨움*/
+	if (!waitq_empty (&sema->waiters))
+		thread_unblock (waitq_pop (&sema->waiters));
+	sema->value++;
+}
+
 /* 세마포어에서 up 또는 "V" 연산. SEMA의 값을 증가시키고,
    대기 중인 스레드가 있다면 하나의 스레드를 깨웁니다.
 
@@ -107,12 +356,7 @@ sema_up (struct semaphore *sema) {
 	ASSERT (sema != NULL);
 	old_level = intr_disable ();
 
-	if (!list_empty (&sema->waiters)){
-		/*PDG 대기락 해제 적용*/
-		list_sort(&sema->waiters, compare_priority, NULL);
-		thread_unblock(list_entry(list_pop_front(&sema->waiters), struct thread, elem));
-	}
-	sema->value++;
+	sema_up_locked (sema);
 	priority_preemption();
 	intr_set_level (old_level);
 }
@@ -162,11 +406,84 @@ sema_test_helper (void *sema_) {
    해제해야 합니다. 이러한 제한이 부담이 될 경우, 세마포어를 사용해야 하는
    좋은 신호입니다. */
 void
-lock_init (struct lock *lock) {
+(lock_init) (struct lock *lock) {
 	ASSERT (lock != NULL);
 
 	lock->holder = NULL;
 	sema_init (&lock->semaphore, 1);
+#ifdef LOCKSTAT
+	lock->class = NULL;
+	lock->hold_start = 0;
+#endif
+}
+
+#ifdef LOCKSTAT
+/* PDG lock_init()과 같지만 LOCK의 통계를 CLASS에 모음.
+   LOCKSTAT 빌드에서는 lock_init() 매크로가 호출 위치마다 CLASS를 만들어 넘김 */
+void
+lock_init_class (struct lock *lock, struct lock_class *class) {
+	(lock_init) (lock);
+	lockstat_register (class);
+	lock->class = class;
+}
+#endif
+
+/* PDG T가 보유한 락들의 대기 큐 맨 앞 스레드 중 가장 높은 donation 우선순위.
+   donation이 없으면 PRI_MIN - 1 반환. 대기 큐가 힙이라 락 하나당 O(1) */
+int
+lock_max_donation (struct thread *t) {
+	int donated = PRI_MIN - 1;
+	struct list_elem *e;
+
+	for (e = list_begin (&t->held_locks); e != list_end (&t->held_locks);
+			e = list_next (e)) {
+		struct lock *lock = list_entry (e, struct lock, elem);
+		struct thread *waiter;
+
+		if (waitq_empty (&lock->semaphore.waiters))
+			continue;
+		waiter = waitq_front (&lock->semaphore.waiters);
+		if (waiter->sched_class->priority_donation
+				&& waiter->priority > donated)
+			donated = waiter->priority;
+	}
+	return donated;
+}
+
+/* PDG nested donation: T가 기다리는 락의 홀더를 따라가며 T의 우선순위를
+   전달. 홀더가 이미 같거나 높으면 그 뒤 체인도 이미 반영된 상태라 중단 */
+static void
+donate_priority (struct thread *t) {
+	struct lock *lock;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while ((lock = t->wait_on_lock) != NULL) {
+		struct thread *holder = lock->holder;
+
+		if (holder == NULL || holder->priority >= t->priority)
+			break;
+		thread_update_priority (holder, t->priority);
+		t = holder;
+	}
+}
+
+/* PDG T부터 wait_on_lock 체인을 따라가며 donation을 다시 계산.
+   타임아웃으로 대기를 포기한 스레드가 준 donation을 거둘 때 사용 */
+static void
+refresh_priority (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while (t != NULL && t->sched_class->priority_donation) {
+		int priority = lock_max_donation (t);
+
+		if (priority < t->org_priority)
+			priority = t->org_priority;
+		if (priority == t->priority)
+			break;
+		thread_update_priority (t, priority);
+		t = t->wait_on_lock != NULL ? t->wait_on_lock->holder : NULL;
+	}
 }
 
 /* LOCK을 획득하고 필요하면 사용할 수 있을 때까지 잠듭니다.
@@ -176,67 +493,73 @@ lock_init (struct lock *lock) {
    이 함수는 인터럽트가 비활성화된 상태에서 호출될 수 있지만,
    필요하면 잠들기 때문에 인터럽트가 다시 활성화될 것입니다. */
 /* PDG 할당이란
-   락의 헤더를 확인해서 해더가 있는 경우 wait_on_lock 으로 대기리스트에 넣기
-   락의 헤더를 확인해서 해더가 없는 경우 헤더를 자신으로 설정
-*/
-/* PDG 할당이란
-   락의 헤더를 확인해서 해더가 있는 경우 wait_on_lock 으로 대기리스트에 넣기
-   락의 헤더를 확인해서 해더가 없는 경우 헤더를 자신으로 설정
+   락의 홀더가 있는 경우 wait_on_lock을 설정하고 홀더 체인에 donation 후 대기
+   락의 홀더가 없는 경우 바로 홀더를 자신으로 설정
+   획득한 락은 held_locks에 넣어 해제할 때 남은 donation을 다시 계산
 */
 void
 lock_acquire (struct lock *lock) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
+
 	ASSERT (lock != NULL);
 	ASSERT (!intr_context ());
 	ASSERT (!lock_held_by_current_thread (lock));
-	/* 덕기 코드*/
-	/*PDG START*/
-	if(!thread_mlfqs){
-		/* 락이 타 쓰레드에 걸려있는 경우 */
-		if (!lock_try_acquire(lock)){
-			/* PDG 해당 쓰레드가 대기하는 락 설정 nested donataion */
-			thread_current()->wait_on_lock = lock;
-			/* PDG 해당 쓰레드를 홀더의 도네이션 리스트에 넣고 홀더에 우선순위 설정 multi donation */
-			list_insert_ordered(&lock->holder->donation, &thread_current()->d_elem, compare_donation_priority, NULL);
-			/* 
-				PDG 락의 홀더에 우선순위를 변경할지 체크 
-				이전 락이 있는 경우 그 전 락도 업데이트 
-			*/
-			//int max list_entry(list_front(&curser->donation), struct thread, d_elem)->priority;
-				
-			struct thread *curser = lock->holder;
-			do{	
-				if(curser->priority < thread_current()->priority){
-					curser->priority = thread_current()->priority;
-					// fix by bada
-					if (!curser->wait_on_lock)
-						break;
-					curser = curser->wait_on_lock->holder;
-				}else{
-					break;
-				}
-			}
-			while(lock->holder->wait_on_lock);
-
-			sema_down (&lock->semaphore);
-			/*
-				무조건 현재 쓰레드를 홀더로 하는 이유
-				위 세마다운에서 block으로 sleep되어 있기 때문
-				semaup 한 경우 세마포어 대기리스트에서 맨처음이 나와서 런되기 때문에
-				해당 쓰레드가 대기리스트 앞의 쓰레드라면
-				바로 락의 홀더로 선정되고 쓰레드 런됨
-				추가로 기다리는 락이 없기 때문에 wait_on_lock = NULL설정
-			*/
-			lock->holder = thread_current();
-		}
-		/* 덕기 코드*/
-
-
-		lock->holder->wait_on_lock = NULL;
+
+	old_level = intr_disable ();
+#ifdef LOCKSTAT
+	uint64_t start = rdtsc ();
+	bool contended = lock->holder != NULL;
+#endif
+	/* PDG donation은 현재 스레드의 스케줄링 클래스가 지원할 때만 (MLFQS는 미지원) */
+	if (lock->holder != NULL && curr->sched_class->priority_donation) {
+		curr->wait_on_lock = lock;
+		donate_priority (curr);
 	}
-	else{
-		sema_down (&lock->semaphore);
-		lock->holder = thread_current();
+	sema_down (&lock->semaphore);
+	curr->wait_on_lock = NULL;
+	lock->holder = curr;
+	list_push_back (&curr->held_locks, &lock->elem);
+#ifdef LOCKSTAT
+	lockstat_acquired (lock, start, contended);
+#endif
+	intr_set_level (old_level);
+}
+
+/* PDG 최대 TICKS 틱 동안만 기다리는 lock_acquire().
+   LOCK을 획득했으면 true, 시간이 다 되었으면 false 반환.
+   시간이 다 되면 홀더 체인에 준 donation을 다시 계산해 거둠 */
+bool
+lock_acquire_timeout (struct lock *lock, int64_t ticks) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
+	bool success;
+
+	ASSERT (lock != NULL);
+	ASSERT (!intr_context ());
+	ASSERT (!lock_held_by_current_thread (lock));
+
+	old_level = intr_disable ();
+#ifdef LOCKSTAT
+	uint64_t start = rdtsc ();
+	bool contended = lock->holder != NULL;
+#endif
+	if (lock->holder != NULL && curr->sched_class->priority_donation) {
+		curr->wait_on_lock = lock;
+		donate_priority (curr);
 	}
+	success = sema_down_timeout (&lock->semaphore, ticks);
+	curr->wait_on_lock = NULL;
+	if (success) {
+		lock->holder = curr;
+		list_push_back (&curr->held_locks, &lock->elem);
+#ifdef LOCKSTAT
+		lockstat_acquired (lock, start, contended);
+#endif
+	} else
+		refresh_priority (lock->holder);
+	intr_set_level (old_level);
+	return success;
 }
 
 /* LOCK을 획득하려고 시도하고 성공하면 true를 반환하고 실패하면 false를 반환합니다.
@@ -245,17 +568,49 @@ lock_acquire (struct lock *lock) {
    이 함수는 잠들지 않으므로 인터럽트 처리기 내에서 호출될 수 있습니다. */
 bool
 lock_try_acquire (struct lock *lock) {
+	enum intr_level old_level;
 	bool success;
 
 	ASSERT (lock != NULL);
 	ASSERT (!lock_held_by_current_thread (lock));
 
+	old_level = intr_disable ();
 	success = sema_try_down (&lock->semaphore);
-	if (success)
+	if (success) {
 		lock->holder = thread_current ();
+		list_push_back (&lock->holder->held_locks, &lock->elem);
+#ifdef LOCKSTAT
+		lockstat_acquired (lock, 0, false);
+#endif
+	}
+	intr_set_level (old_level);
 	return success;
 }
 
+/* PDG lock_release()에서 선점 검사를 뺀 부분. 인터럽트가 꺼진 상태에서 호출.
+   LOCK의 대기 스레드가 주던 donation은 LOCK을 held_locks에서 빼는 것만으로
+   사라지므로 남은 락들의 대기 큐 맨 앞으로 우선순위를 다시 계산 */
+static void
+lock_release_locked (struct lock *lock) {
+	struct thread *curr = thread_current ();
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+#ifdef LOCKSTAT
+	lockstat_released (lock);
+#endif
+	list_remove (&lock->elem);
+	lock->holder = NULL;
+	if (curr->sched_class->priority_donation) {
+		int donated = lock_max_donation (curr);
+
+		thread_update_priority (curr, donated > curr->org_priority
+				? donated : curr->org_priority);
+	}
+	//세마포어 업 대기에서 ready 리스트로 첫번쨰 대기 쓰래드 전환
+	sema_up_locked (&lock->semaphore);
+}
+
 /* 현재 스레드가 소유한 LOCK을 해제합니다.
    이것은 lock_release 함수입니다.
 
@@ -263,59 +618,15 @@ lock_try_acquire (struct lock *lock) {
    락을 해제하려고 시도해서는 안 됩니다. */
 void
 lock_release (struct lock *lock) {
+	enum intr_level old_level;
+
 	ASSERT (lock != NULL);
 	ASSERT (lock_held_by_current_thread (lock));
-	if(!thread_mlfqs){
-		/* 덕기 코드*/
-		//PDG 도네이션 순회하여 해당 락의 도네이션 제거
-		struct thread *cur = thread_current ();
-		struct list_elem *e = list_begin(&cur->donation);
-		struct list_elem *next;
-		
-		//thread_set_priority(thread_current()->org_priority);
-
-		while(e != list_tail(&lock->holder->donation)){
-			next = e->next;
-			if (list_entry(e, struct thread, d_elem)->wait_on_lock == lock)
-				list_remove(e);
-			e = next;
-		}
-		// //PDG 해당 락의 홀더의 우선순위 갱신
-		// if(!list_empty(&lock->holder->donation)){
-		// 	int max_value = list_entry(list_begin(&lock->holder->donation), struct thread, d_elem)->priority;	
-		// 	if(lock->holder->priority < max_value){
-		// 		thread_set_priority(max_value);
-		// 	}
-
-		// }
-		struct thread *curser = lock->holder;
-		do{	
-			if(list_empty(&curser->donation)){
-				curser->priority = curser->org_priority;
-				// curser = curser->wait_on_lock->holder;
-				break;
-			}
-			if(curser->org_priority < list_entry(list_begin(&curser->donation), struct thread, d_elem)->priority){
-				curser->priority = list_entry(list_begin(&curser->donation), struct thread, d_elem)->priority;
-				// fix by bada
-				if (!curser->wait_on_lock)
-					break;
-				curser = curser->wait_on_lock->holder;
-			}else{
-				break;
-			}
-		}
-		while(lock->holder->wait_on_lock);
-		/* 덕기 코드*/
-
-		//홀더 제거
-		lock->holder = NULL;
-		//세마포어 업 대기에서 ready 리스트로 첫번쨰 대기 쓰래드 전환
-		sema_up (&lock->semaphore);
-	}else{
-		lock->holder = NULL;
-		sema_up (&lock->semaphore);
-	}
+
+	old_level = intr_disable ();
+	lock_release_locked (lock);
+	priority_preemption ();
+	intr_set_level (old_level);
 }
 
 /* 현재 스레드가 LOCK을 소유하고 있으면 true를 반환하고, 그렇지 않으면 false를 반환합니다.
@@ -327,19 +638,13 @@ lock_held_by_current_thread (const struct lock *lock) {
 	return lock->holder == thread_current ();
 }
 
-/* 목록에 있는 하나의 세마포어. */
-struct semaphore_elem {
-	struct list_elem elem;              /* 목록 요소. */
-	struct semaphore semaphore;         /* 이 세마포어. */
-};
-
 /* 조건 변수 COND를 초기화합니다. 조건 변수는 한 코드 조각이 조건을 신호하고,
    협력하는 코드가 신호를 받고 이에 따라 행동할 수 있게 합니다. */
 void
 cond_init (struct condition *cond) {
 	ASSERT (cond != NULL);
 
-	list_init (&cond->waiters);
+	waitq_init (&cond->waiters);
 }
 
 /* LOCK을 원자적으로 해제하고 다른 코드 조각이 COND에 신호를 보낼 때까지 기다립니다.
@@ -358,20 +663,48 @@ cond_init (struct condition *cond) {
    필요하면 잠들기 때문에 인터럽트가 다시 활성화될 것입니다. */
 void
 cond_wait (struct condition *cond, struct lock *lock) {
-	struct semaphore_elem waiter;
+	enum intr_level old_level;
+
+	ASSERT (cond != NULL);
+	ASSERT (lock != NULL);
+	ASSERT (!intr_context ());
+	ASSERT (lock_held_by_current_thread (lock));
+
+	/* PDG 스레드 자체를 대기 큐에 넣고 block. 큐에 들어간 뒤 block 전에
+	   선점되면 안 되므로 락 해제는 선점 검사 없이 인터럽트가 꺼진 채로 */
+	old_level = intr_disable ();
+	waitq_push (&cond->waiters, thread_current ());
+	lock_release_locked (lock);
+	thread_block ();
+	intr_set_level (old_level);
+	lock_acquire (lock);
+}
+
+/* PDG 최대 TICKS 틱 동안만 신호를 기다리는 cond_wait().
+   신호를 받았으면 true, 시간이 다 되었으면 false 반환.
+   어느 쪽이든 반환하기 전에 LOCK을 다시 획득 */
+bool
+cond_wait_timeout (struct condition *cond, struct lock *lock, int64_t ticks) {
+	struct wait_timeout to;
+	enum intr_level old_level;
 
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 	ASSERT (!intr_context ());
 	ASSERT (lock_held_by_current_thread (lock));
 
-	sema_init (&waiter.semaphore, 0);
-	//list_push_back (&cond->waiters, &waiter.elem);
-	// PDG
-	list_insert_ordered (&cond->waiters, &waiter.elem, sema_compare_priority, NULL);	
-	lock_release (lock);
-	sema_down (&waiter.semaphore);
+	if (ticks <= 0)
+		return false;
+
+	old_level = intr_disable ();
+	wait_timeout_start (&to, ticks);
+	waitq_push (&cond->waiters, thread_current ());
+	lock_release_locked (lock);
+	thread_block ();
+	timer_cancel (&to.event);
+	intr_set_level (old_level);
 	lock_acquire (lock);
+	return !to.woke;
 }
 
 /* 만약 COND(LOCK으로 보호됨)에 대기 중인 스레드가 있다면,
@@ -382,29 +715,18 @@ cond_wait (struct condition *cond, struct lock *lock) {
    조건 변수 내에서 신호를 보내려고 시도해서는 안 됩니다. */
 void
 cond_signal (struct condition *cond, struct lock *lock UNUSED) {
+	enum intr_level old_level;
+
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
 	ASSERT (!intr_context ());
 	ASSERT (lock_held_by_current_thread (lock));
 
-	if (!list_empty (&cond->waiters)){
-		list_sort(&cond->waiters, sema_compare_priority, 0);
-		sema_up (&list_entry (list_pop_front (&cond->waiters),
-					struct semaphore_elem, elem)->semaphore);
-	}
-}
-
-
-// 여러 세마포어들의 리스트 중 가장 우선순위가 높은 하나의 세마포 깨우기 위한 힘수
-bool sema_compare_priority(const struct list_elem *higher, const struct list_elem *lower, void *aux UNUSED) {
-	struct semaphore_elem *higher_sema = list_entry(higher, struct semaphore_elem, elem);
-	struct semaphore_elem *lower_sema = list_entry(lower, struct semaphore_elem, elem);
-
-	struct list *waiter_higher_sema = &(higher_sema->semaphore.waiters);
-	struct list *watier_lower_sema = &(lower_sema->semaphore.waiters);
-
-	return list_entry(list_begin(waiter_higher_sema), struct thread, elem)->priority 
-			> list_entry(list_begin(watier_lower_sema), struct thread, elem)->priority;
+	old_level = intr_disable ();
+	if (!waitq_empty (&cond->waiters))
+		thread_unblock (waitq_pop (&cond->waiters));
+	priority_preemption ();
+	intr_set_level (old_level);
 }
 
 /* COND(LOCK으로 보호됨)에서 대기 중인 모든 스레드를 깨웁니다.
@@ -414,9 +736,242 @@ bool sema_compare_priority(const struct list_elem *higher, const struct list_ele
    조건 변수 내에서 신호를 보내려고 시도해서는 안 됩니다. */
 void
 cond_broadcast (struct condition *cond, struct lock *lock) {
+	enum intr_level old_level;
+
 	ASSERT (cond != NULL);
 	ASSERT (lock != NULL);
+	ASSERT (!intr_context ());
+	ASSERT (lock_held_by_current_thread (lock));
+
+	//PDG 우선순위 순서대로 모두 깨운 뒤 선점 검사는 한 번만
+	old_level = intr_disable ();
+	while (!waitq_empty (&cond->waiters))
+		thread_unblock (waitq_pop (&cond->waiters));
+	priority_preemption ();
+	intr_set_level (old_level);
+}
+
+/* Initializes reader-writer lock RW.  Any number of readers, or
+   one writer, may hold RW at once.  RW prefers writers: once a
+   writer waits, new readers wait behind it, so a stream of
+   readers cannot starve writers.
 
-	while (!list_empty (&cond->waiters))
-		cond_signal (cond, lock);
-}
\ No newline at end of file
+   The writer holds RW's internal lock for as long as it holds
+   RW, and readers that find a writer pass through that lock, so
+   every thread waiting on the writer donates its priority to it
+   like a lock waiter does.  Readers receive no donation. */
+void
+rwlock_init (struct rwlock *rw) {
+	ASSERT (rw != NULL);
+
+	lock_init (&rw->lock);
+	rw->readers = 0;
+	rw->writers = 0;
+	waitq_init (&rw->drain);
+}
+
+/* Acquires RW for reading, sleeping until no writer holds or
+   waits for it.  Readers may nest, but a thread that holds RW for
+   reading must not acquire it for writing.
+
+   A thread that already holds some reader-writer lock for reading
+   goes ahead of waiting writers as long as RW has readers, since
+   a writer waiting for it to leave RW would otherwise deadlock
+   with it.  Readers keep the writer from holding RW, so this
+   costs waiting writers only fairness.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_read_acquire (struct rwlock *rw) {
+	struct thread *curr = thread_current ();
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+	ASSERT (!rwlock_write_held_by_current_thread (rw));
+
+	old_level = intr_disable ();
+	curr->rw_reads++;
+	if (rw->writers == 0 || (rw->readers > 0 && curr->rw_reads > 1))
+		rw->readers++;
+	else {
+		/* Queue up with the writers, donating to the one that
+		   holds RW, and join the readers once it is our turn. */
+		lock_acquire (&rw->lock);
+		rw->readers++;
+		lock_release (&rw->lock);
+	}
+	intr_set_level (old_level);
+}
+
+/* Releases RW, which the current thread holds for reading.  The
+   last reader out wakes up a writer waiting for the readers to
+   leave. */
+void
+rwlock_read_release (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+
+	old_level = intr_disable ();
+	ASSERT (rw->readers > 0);
+	ASSERT (thread_current ()->rw_reads > 0);
+	thread_current ()->rw_reads--;
+	if (--rw->readers == 0 && !waitq_empty (&rw->drain))
+		thread_unblock (waitq_pop (&rw->drain));
+	priority_preemption ();
+	intr_set_level (old_level);
+}
+
+/* Acquires RW for writing, sleeping until no other writer holds
+   it and every reader has left.  The current thread must not
+   already hold RW.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_write_acquire (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	rw->writers++;
+	lock_acquire (&rw->lock);
+	while (rw->readers > 0) {
+		waitq_push (&rw->drain, thread_current ());
+		thread_block ();
+	}
+	intr_set_level (old_level);
+}
+
+/* Releases RW, which the current thread holds for writing. */
+void
+rwlock_write_release (struct rwlock *rw) {
+	enum intr_level old_level;
+
+	ASSERT (rw != NULL);
+	ASSERT (rwlock_write_held_by_current_thread (rw));
+
+	old_level = intr_disable ();
+	rw->writers--;
+	lock_release (&rw->lock);
+	intr_set_level (old_level);
+}
+
+/* Returns true if the current thread holds RW for writing. */
+bool
+rwlock_write_held_by_current_thread (const struct rwlock *rw) {
+	ASSERT (rw != NULL);
+
+	return lock_held_by_current_thread (&rw->lock);
+}
+
+/* Initializes spinlock L to unlocked. */
+void
+spin_lock_init (struct spinlock *l) {
+	ASSERT (l != NULL);
+	l->locked = 0;
+}
+
+/* Tries to acquire L without spinning.  Returns true if
+   successful. */
+bool
+spin_try_lock (struct spinlock *l) {
+	int old = 1;
+
+	ASSERT (l != NULL);
+	asm volatile ("xchgl %0, %1" : "+r" (old), "+m" (l->locked) : : "memory");
+	return old == 0;
+}
+
+/* Acquires L, spinning until it is free.  Spins on a plain read
+   so that waiting CPUs do not keep bouncing the cache line. */
+void
+spin_lock (struct spinlock *l) {
+	while (!spin_try_lock (l))
+		while (l->locked)
+			asm volatile ("pause");
+}
+
+/* Releases L. */
+void
+spin_unlock (struct spinlock *l) {
+	ASSERT (l->locked);
+	barrier ();
+	l->locked = 0;
+}
+
+/* Initializes sequence lock SL.
+
+   A sequence lock protects a small record that is read far more
+   often than it is written, such as a set of counters, without
+   making readers write anything.  A reader copies the record
+   between seqlock_read_begin() and seqlock_read_retry(), and
+   starts over if the latter returns true because a writer got in
+   the way:
+
+        unsigned seq;
+        do {
+          seq = seqlock_read_begin (&sl);
+          copy = record;
+        } while (seqlock_read_retry (&sl, seq));
+
+   Writers exclude each other and run with interrupts off, so a
+   reader never waits for a writer on the same CPU, and readers
+   may run in interrupt handlers.  The record must not contain
+   pointers that a reader follows, since a reader may see it half
+   written before it retries. */
+void
+seqlock_init (struct seqlock *sl) {
+	ASSERT (sl != NULL);
+	sl->seq = 0;
+	spin_lock_init (&sl->lock);
+}
+
+/* Starts a read of the record protected by SL, waiting for a
+   write in progress on another CPU to finish, and returns the
+   sequence number to pass to seqlock_read_retry(). */
+unsigned
+seqlock_read_begin (const struct seqlock *sl) {
+	unsigned seq;
+
+	while ((seq = sl->seq) & 1)
+		asm volatile ("pause");
+	barrier ();
+	return seq;
+}
+
+/* Returns true if the record protected by SL changed since the
+   seqlock_read_begin() that returned SEQ, meaning that what was
+   read must be thrown away and read again. */
+bool
+seqlock_read_retry (const struct seqlock *sl, unsigned seq) {
+	barrier ();
+	return sl->seq != seq;
+}
+
+/* Starts a write of the record protected by SL.  Turns
+   interrupts off and returns the previous interrupt level, to be
+   passed to seqlock_write_end(). */
+enum intr_level
+seqlock_write_begin (struct seqlock *sl) {
+	enum intr_level old_level = intr_disable ();
+
+	spin_lock (&sl->lock);
+	sl->seq++;
+	barrier ();
+	return old_level;
+}
+
+/* Finishes a write of the record protected by SL and restores
+   interrupt level OLD_LEVEL. */
+void
+seqlock_write_end (struct seqlock *sl, enum intr_level old_level) {
+	barrier ();
+	sl->seq++;
+	spin_unlock (&sl->lock);
+	intr_set_level (old_level);
+}
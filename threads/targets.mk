@@ -1,9 +1,19 @@
 threads_SRC  = threads/init.c		# Main program.
 threads_SRC += threads/thread.c		# Thread management core.
+threads_SRC += threads/switch.S		# Thread switch routine.
+threads_SRC += threads/sched.c		# Scheduling classes.
+threads_SRC += threads/sched_fair.c	# Completely fair scheduling class.
+threads_SRC += threads/sched_dl.c	# Earliest deadline first class.
 threads_SRC += threads/interrupt.c	# Interrupt core.
+threads_SRC += threads/irqsoff.c	# Interrupts-off latency tracer.
+threads_SRC += threads/profile.c	# Sampling CPU profiler.
 threads_SRC += threads/intr-stubs.S	# Interrupt stubs.
 threads_SRC += threads/synch.c		# Synchronization.
+threads_SRC += threads/workqueue.c	# Deferred work.
+threads_SRC += threads/lockstat.c	# Lock contention statistics.
 threads_SRC += threads/palloc.c		# Page allocator.
 threads_SRC += threads/malloc.c		# Subpage allocator.
+threads_SRC += threads/slab.c		# Object caches.
 threads_SRC += threads/start.S		# Startup code.
+threads_SRC += threads/lapic.c		# Local APIC.
 threads_SRC += threads/mmu.c		    # Memory management unit related things.
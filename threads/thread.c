@@ -4,12 +4,21 @@
 #include <random.h>
 #include <stdio.h>
 #include <string.h>
+#include <round.h>
 #include "threads/flags.h"
+#include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/irqsoff.h"
+#include "threads/mmu.h"
 #include "threads/palloc.h"
+#include "threads/pte.h"
+#include "threads/sched.h"
+#include "threads/switch.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
+#include "threads/workqueue.h"
+#include "devices/timer.h"
 #include "intrinsic.h"
 #include "include/threads/fixed_point.h"
 #ifdef USERPROG
@@ -30,21 +39,39 @@
 #define RECENT_CPU_DEFAULT 0
 #define LOAD_AVG_DEFAULT 0
 
-/* PDG MLFQ 기본값 셋팅*/
-#define NICE_DEFAULT 0
-#define RECENT_CPU_DEFAULT 0
-#define LOAD_AVG_DEFAULT 0
+/* Lists of processes in THREAD_READY state, that is, processes
+   that are ready to run but not actually running.
+   PDG normal 클래스의 우선순위별 FIFO 큐 */
+static struct prio_rq normal_rq;
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* PDG ready 상태 스레드 수 (모든 클래스 합계) */
+static size_t ready_cnt;
 
-/* PDG 수면리스트 */
-static struct list sleep_list;
+/* PDG 스케줄링 클래스, rank 순서 (앞쪽 클래스가 항상 먼저 실행) */
+static const struct sched_class *sched_classes[4];
+static int sched_class_cnt;
+
+/* PDG SCHED_NORMAL 클래스: -sched=cfs 이면 fair_sched_class,
+   -mlfqs 이면 mlfqs_sched_class, 아니면 prio_sched_class */
+static const struct sched_class *normal_class;
+static const struct sched_class prio_sched_class;
+static const struct sched_class mlfqs_sched_class;
 
 /* PDG 모든 스레드 리스트 */
 static struct list all_list;
 
+/* PDG MLFQ recent_cpu 감쇠 계수 기록.
+   1초마다 계수를 한번만 계산해서 decay_hist에 남기고 실행/ready 스레드에만
+   바로 적용. block된 스레드는 다음에 깨어날 때 밀린 감쇠를 한번에 적용 */
+#define DECAY_HIST 128
+static fixed decay_hist[DECAY_HIST];   /* decay_hist[e % DECAY_HIST]: e초 -> e+1초 계수 */
+static int64_t mlfqs_epoch;            /* 지금까지 지난 MLFQ 초 */
+
+/* PDG MLFQ 1초 재계산은 타이머 인터럽트 안이 아니라 인터럽트 리턴시
+   softirq로 실행. 실행 전에 여러 초가 지나면 밀린 횟수만큼 재계산 */
+static struct work mlfqs_work;
+static unsigned mlfqs_recalc_due;
+
 /* Idle thread. */
 static struct thread *idle_thread;
 
@@ -57,13 +84,22 @@ static struct lock tid_lock;
 /* Thread destruction requests */
 static struct list destruction_req;
 
-/* Statistics. */
-static long long idle_ticks;    /* # of timer ticks spent idle. */
-static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
-static long long user_ticks;    /* # of timer ticks in user programs. */
+/* PDG 재사용할 스레드 블록 캐시. do_schedule()에서 회수한 블록을 가드 페이지
+   매핑이 해제된 채로 보관했다가 thread_create()에서 palloc 없이 바로 사용 */
+static struct list thread_cache;
+static size_t thread_cache_cnt;
+
+/* PDG 캐시에 보관할 최대 블록 수. 커널 옵션 "-tcache=N", 0이면 캐시 안함 */
+size_t thread_cache_max = 16;
+
+/* Statistics, in nanoseconds of timer_now_ns(), accounted at
+   every thread switch. */
+static int64_t idle_ns;         /* Time spent idle. */
+static int64_t kernel_ns;       /* Time in kernel threads. */
+static int64_t user_ns;         /* Time in user programs. */
+static int64_t account_ns;      /* Time of last accounting. */
 
 /* Scheduling. */
-#define TIME_SLICE 4            /* # of timer ticks to give each thread. */
 static unsigned thread_ticks;   /* # of timer ticks since last yield. */
 
 /* If false (default), use round-robin scheduler.
@@ -71,6 +107,17 @@ static unsigned thread_ticks;   /* # of timer ticks since last yield. */
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* PDG -sched=cfs: normal 클래스 대신 CFS 클래스 사용 */
+bool thread_cfs;
+
+/* PDG -switch=iret: 모든 문맥교환을 thread_launch()의 intr_frame 저장 +
+   iretq로 수행 (비교용 예전 경로) */
+bool thread_iret_switch;
+
+/* Stack frame offset of struct thread's `stack' member.
+   Used by switch.S, which can't figure it out on its own. */
+const size_t thread_stack_ofs = offsetof (struct thread, stack);
+
 
 
 static void kernel_thread (thread_func *, void *aux);
@@ -81,61 +128,75 @@ static void init_thread (struct thread *, const char *name, int priority);
 static void do_schedule(int status);
 static void schedule (void);
 static tid_t allocate_tid (void);
-
-
-
-
-/* PDG 우선순위 비교하여 문맥교환 */
+static void thread_sleep_expired (void *t);
+static void sched_enqueue (struct thread *);
+static bool sched_need_resched (struct thread *);
+static struct thread *thread_alloc (void);
+static void thread_free (struct thread *);
+static void thread_recycle (struct thread *);
+static void set_guard (void *page, bool present);
+static void account_cpu_time (struct thread *);
+static void sched_change_class (struct thread *, enum sched_policy,
+		const struct sched_class *);
+static void mlfqs_clock (void);
+static void mlfqs_recalc (void);
+static void mlfqs_recalc_work (void *);
+static int mlfqs_calc_priority (struct thread *);
+static void mlfqs_priority (struct thread *);
+static void mlfqs_increment (void);
+static void mlfqs_load_avg (void);
+static void mlfqs_catch_up (struct thread *);
+static void mlfqs_refresh (struct thread *);
+
+
+
+
+/* PDG 현재 스레드보다 먼저 실행되어야 할 ready 스레드가 있으면 문맥교환 */
 void priority_preemption() {
-	if (list_empty(&ready_list))
+	if (ready_cnt == 0)
 		return;
 	// 인터럽트 컨텍스트인 경우 동작하지 않음
 	if(intr_context())
 		return;
 	
-	struct thread *t = list_entry(list_front(&ready_list), struct thread, elem);
-	if (thread_current()->priority < t->priority)
+	if (sched_need_resched (thread_current ()))
 		thread_yield();
 }
 
-/* PDG 글로벌 쓰레드 웨이크업 틱스  */
-int64_t global_ticks = INT64_MAX;
-
 /* PDG 글로벌 쓰레드 웨이크업 틱스  */
 int load_avg;
 
 /* Returns true if T appears to point to a valid thread. */
 #define is_thread(t) ((t) != NULL && (t)->magic == THREAD_MAGIC)
 
+/* PDG 커널 스택 페이지 수. 커널 옵션 "-kstack=KB"로 8 또는 16 KiB */
+size_t thread_stack_pages = 2;
+
+/* PDG 스레드 블록 크기 (바이트). struct thread 페이지 + 가드 페이지 +
+   스택을 담는 2의 거듭제곱이고, 블록은 이 크기로 정렬됨.
+   초기 스레드의 부트 스택(물리 주소 0)도 어떤 크기로든 정렬되어 있음 */
+static uint64_t thread_block_size = 4 * PGSIZE;
+
 /* Returns the running thread.
  * Read the CPU's stack pointer `rsp', and then round that
- * down to the start of a page.  Since `struct thread' is
- * always at the beginning of a page and the stack pointer is
+ * down to the start of its thread block.  Since `struct thread'
+ * is always at the beginning of a block and the stack pointer is
  * somewhere in the middle, this locates the curent thread. */
-#define running_thread() ((struct thread *) (pg_round_down (rrsp ())))
+#define running_thread() \
+	((struct thread *) (rrsp () & ~(thread_block_size - 1)))
 
 // Global descriptor table for the thread_start.
 // Because the gdt will be setup after the thread_init, we should
 // setup temporal gdt first.
 static uint64_t gdt[3] = { 0, 0x00af9a000000ffff, 0x00cf92000000ffff };
 
-bool compare_wake_tick(const struct list_elem *a_, const struct list_elem *b_, void *aux UNUSED){
-	const struct thread *a = list_entry (a_, struct thread, elem);
-	const struct thread *b = list_entry (b_, struct thread, elem);
-
-	return a->wakeup_tick < b->wakeup_tick;
-}
-
 bool compare_priority(const struct list_elem *curr, const struct list_elem *new, void *aux UNUSED){
 	const struct thread *a = list_entry (curr, struct thread, elem);
 	const struct thread *b = list_entry (new, struct thread, elem);
 
-	return a->priority > b->priority;
-}
-bool compare_donation_priority(const struct list_elem *curr, const struct list_elem *new, void *aux UNUSED){
-	const struct thread *a = list_entry (curr, struct thread, d_elem);
-	const struct thread *b = list_entry (new, struct thread, d_elem);
-
+	//PDG 클래스가 다르면 rank가 낮은(먼저 실행되는) 클래스 우선
+	if (a->sched_class->rank != b->sched_class->rank)
+		return a->sched_class->rank < b->sched_class->rank;
 	return a->priority > b->priority;
 }
 
@@ -167,14 +228,33 @@ thread_init (void) {
 
 	/* Init the globla thread context */
 	lock_init (&tid_lock);
-	list_init (&ready_list);
-	/* PDG */
-	list_init (&sleep_list);
+	/* PDG 스케줄링 클래스를 rank 순서로 등록 */
+	if (thread_cfs)
+		normal_class = &fair_sched_class;
+	else if (thread_mlfqs)
+		normal_class = &mlfqs_sched_class;
+	else
+		normal_class = &prio_sched_class;
+	sched_class_cnt = 0;
+	sched_classes[sched_class_cnt++] = &dl_sched_class;
+	sched_classes[sched_class_cnt++] = &rt_sched_class;
+	sched_classes[sched_class_cnt++] = normal_class;
+	sched_classes[sched_class_cnt++] = &idle_sched_class;
+	for (int i = 0; i < sched_class_cnt; i++)
+		sched_classes[i]->init ();
+	ready_cnt = 0;
 	/* PDG MLFQ 전체리스트 초기화*/
 	list_init (&all_list);
 	list_init (&destruction_req);
+	list_init (&thread_cache);
+	work_init (&mlfqs_work, mlfqs_recalc_work, NULL);
 
 	/* Set up a thread structure for the running thread. */
+	/* PDG 스택 페이지 수에 맞는 스레드 블록 크기 결정 */
+	thread_block_size = PGSIZE;
+	while (thread_block_size < (thread_stack_pages + 2) * PGSIZE)
+		thread_block_size *= 2;
+
 	initial_thread = running_thread ();
 	init_thread (initial_thread, "main", PRI_DEFAULT);
 	initial_thread->status = THREAD_RUNNING;
@@ -207,26 +287,73 @@ void
 thread_tick (void) {
 	struct thread *t = thread_current ();
 
-	/* Update statistics. */
-	if (t == idle_thread)
-		idle_ticks++;
-#ifdef USERPROG
-	else if (t->pml4 != NULL)
-		user_ticks++;
-#endif
-	else
-		kernel_ticks++;
-
-	/* Enforce preemption. */
-	if (++thread_ticks >= TIME_SLICE)
+	/* PDG 클래스 전체 주기 작업 (MLFQS load_avg 등) */
+	for (int i = 0; i < sched_class_cnt; i++)
+		if (sched_classes[i]->clock != NULL)
+			sched_classes[i]->clock ();
+
+	/* Enforce preemption.
+	   PDG 타임 슬라이스 판단은 실행중인 스레드의 클래스가 결정.
+	   tickless 모드에서 idle 스레드가 밀린 틱을 따라잡을 때는
+	   인터럽트 컨텍스트가 아니므로 양보하지 않음 */
+	++thread_ticks;
+	if (t != idle_thread && t->sched_class->tick (t, thread_ticks)
+			&& intr_context ())
 		intr_yield_on_return ();
 }
 
 /* Prints thread statistics. */
 void
 thread_print_stats (void) {
+	enum intr_level old_level = intr_disable ();
+	int64_t idle, kernel, user;
+
+	account_cpu_time (thread_current ());
+	idle = idle_ns;
+	kernel = kernel_ns;
+	user = user_ns;
+	intr_set_level (old_level);
+
 	printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
-			idle_ticks, kernel_ticks, user_ticks);
+			(long long) (idle * TIMER_FREQ / 1000000000),
+			(long long) (kernel * TIMER_FREQ / 1000000000),
+			(long long) (user * TIMER_FREQ / 1000000000));
+	printf ("Thread: %lld us idle, %lld us kernel, %lld us user\n",
+			(long long) (idle / 1000), (long long) (kernel / 1000),
+			(long long) (user / 1000));
+}
+
+/* PDG 마지막 계산 이후 흐른 시간을 실행 중인 T의 CPU 시간과 전체 통계에 더함.
+   인터럽트가 꺼진 상태에서 호출 */
+static void
+account_cpu_time (struct thread *t) {
+	int64_t now = timer_now_ns ();
+	int64_t delta = now - account_ns;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	account_ns = now;
+	t->cpu_ns += delta;
+	if (t == idle_thread)
+		idle_ns += delta;
+#ifdef USERPROG
+	else if (t->pml4 != NULL)
+		user_ns += delta;
+#endif
+	else
+		kernel_ns += delta;
+}
+
+/* PDG 현재 스레드가 지금까지 사용한 CPU 시간 (나노초) */
+int64_t
+thread_get_cpu_ns (void) {
+	enum intr_level old_level = intr_disable ();
+	int64_t cpu_ns;
+
+	account_cpu_time (thread_current ());
+	cpu_ns = thread_current ()->cpu_ns;
+	intr_set_level (old_level);
+	return cpu_ns;
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -247,12 +374,13 @@ thread_print_stats (void) {
 tid_t
 thread_create (const char *name, int priority, thread_func *function, void *aux) {
 	struct thread *t;
+	struct switch_threads_frame *sf;
 	tid_t tid;
 
 	ASSERT (function != NULL);
 
 	/* Allocate thread. */
-	t = palloc_get_page (PAL_ZERO);
+	t = thread_alloc ();
 	if (t == NULL)
 		return TID_ERROR;
 
@@ -271,6 +399,13 @@ thread_create (const char *name, int priority, thread_func *function, void *aux)
 	t->tf.cs = SEL_KCSEG;
 	t->tf.eflags = FLAG_IF;
 
+	/* PDG 처음 switch_threads()로 전환될 때 switch_entry로 돌아가
+	   위의 tf로 진입하도록 스택 꼭대기에 프레임 구성 */
+	sf = (struct switch_threads_frame *) thread_stack_top (t) - 1;
+	sf->rbx = (uint64_t) &t->tf;
+	sf->rip = switch_entry;
+	t->stack = (uint8_t *) sf;
+
 	/* PDG MLFQ 전체 관리를 위한 리스트 추가 */
 	list_push_back(&all_list, &t->a_elem);
 
@@ -298,50 +433,36 @@ thread_create (const char *name, int priority, thread_func *function, void *aux)
 	return tid;
 }
 
-/* PDG 쓰레드를 정지 시키고 sleep 리스트에 추가하는 함수 생성 */
+/* PDG 쓰레드를 정지 시키고 TICKS 틱에 깨우는 타이머 등록 */
 void thread_sleep(int64_t ticks){
 	struct thread *curr = thread_current();
-	
-	struct thread *sleep_head;
-	
+	struct timer_event wakeup;
 	enum intr_level old_level;
-	
-	old_level = intr_disable ();
-	
-	if (curr != idle_thread){
-		curr->wakeup_tick = ticks;
-		list_insert_ordered(&sleep_list, &curr->elem, compare_wake_tick, NULL);
-		
-		sleep_head = list_entry(list_begin(&sleep_list), struct thread, elem);
-	}
-	global_ticks = sleep_head->wakeup_tick;
-	thread_block();
-	intr_set_level (old_level);
-}
 
-/* PDG 쓰레드를 정지 풀고시키고 ready 리스트에 추가하는 함수 생성 */
-void thread_wakeup(){
-	if(list_empty(&sleep_list))
+	if (curr == idle_thread)
 		return;
 
-	struct thread *wakeup_thread = list_entry(list_pop_front(&sleep_list), struct thread, elem);
-	
-	enum intr_level old_level;
+	timer_event_init (&wakeup, thread_sleep_expired, curr);
 	old_level = intr_disable ();
-
-	thread_unblock(wakeup_thread);
-
-	if(list_empty(&sleep_list)){
-		global_ticks = INT64_MAX;
-	}else{
-		global_ticks = list_entry(list_begin(&sleep_list), struct thread, elem)->wakeup_tick;
-	}
-	
+	timer_add (&wakeup, ticks);
+	thread_block();
 	intr_set_level (old_level);
 }
 
-int64_t get_globalticks(){
-	return global_ticks;
+/* PDG 수면 타이머 만료 콜백, 타이머 인터럽트 안에서 실행 */
+static void
+thread_sleep_expired (void *t) {
+	thread_wake (t);
+}
+
+/* PDG 타이머 콜백 등에서 block된 T를 깨움. 깨어난 스레드가 먼저
+   실행되어야 하면 (예: RT 클래스) 슬라이스를 기다리지 않고
+   인터럽트 리턴시 양보 */
+void
+thread_wake (struct thread *t) {
+	thread_unblock (t);
+	if (intr_context () && sched_need_resched (thread_current ()))
+		intr_yield_on_return ();
 }
 
 /* Puts the current thread to sleep.  It will not be scheduled
@@ -375,10 +496,8 @@ thread_unblock (struct thread *t) {
 	old_level = intr_disable ();
 	ASSERT (t->status == THREAD_BLOCKED);
 	
-	//PDG 주석 처리
-	//list_push_back (&ready_list, &t->elem);
-	//PDG ADD 우선 순위 정렬
-	list_insert_ordered(&ready_list, &t-> elem, compare_priority, NULL); 
+	//PDG 자신의 스케줄링 클래스 큐에 추가
+	sched_enqueue (t);
 	t->status = THREAD_READY;
 	intr_set_level (old_level);
 }
@@ -427,6 +546,10 @@ thread_exit (void) {
 	   We will be destroyed during the call to schedule_tail(). */
 	intr_disable ();
 	
+	/* PDG 클래스가 잡고 있던 자원 반환 (EDF 대역폭 등) */
+	if (thread_current ()->sched_class->detach != NULL)
+		thread_current ()->sched_class->detach (thread_current ());
+
 	/*PDG MLFQ alllist 제거*/
 	list_remove(&thread_current()->a_elem);
 	do_schedule (THREAD_DYING);
@@ -443,29 +566,111 @@ thread_yield (void) {
 	ASSERT (!intr_context ());
 
 	old_level = intr_disable ();
-	if (curr != idle_thread){
-		//PDG 주석처리
-		//list_push_back (&ready_list, &curr->elem);
-
-		//PDG 우선순위로 변경
-		list_insert_ordered(&ready_list, &curr->elem, compare_priority, NULL);
+	/* PDG 예산을 다 쓴 EDF 스레드는 다음 주기 타이머가 깨울 때까지 block */
+	if (curr->dl_throttled)
+		thread_block ();
+	else {
+		if (curr != idle_thread) {
+			curr->sched_class->yield (curr);
+			ready_cnt++;
+		} else
+			/* PDG 다른 인터럽트가 깨운 스레드로 복귀 시 바로 넘어가면 idle
+			   루프 맨 위를 거치지 않으므로, 여기서 one-shot을 해제하고
+			   주기 틱으로 돌아가야 타임 슬라이스와 timer_sleep이 제때 처리됨 */
+			timer_idle_exit ();
+		do_schedule (THREAD_READY);
 	}
-	do_schedule (THREAD_READY);
 	intr_set_level (old_level);
 }
 
 /* Sets the current thread's priority to NEW_PRIORITY. */
 void
 thread_set_priority (int new_priority) {
-	if(!thread_mlfqs){
-		if (thread_current()->org_priority == thread_current()->priority)
-			thread_current()->priority = new_priority;
-		thread_current()->org_priority = new_priority;
-		priority_preemption();
-	}else{
-		thread_current()->priority = new_priority;
+	struct thread *curr = thread_current ();
+
+	//PDG donation을 쓰지 않는 클래스는 바로 반영, 쓰는 클래스는 받고 있는 donation과 비교
+	curr->org_priority = new_priority;
+	if (curr->sched_class->priority_donation) {
+		int donated = lock_max_donation (curr);
+		thread_update_priority (curr,
+				donated > new_priority ? donated : new_priority);
+	} else
+		curr->priority = new_priority;
+	priority_preemption();
+}
+
+/* PDG T의 스케줄링 정책을 POLICY, 우선순위를 PRIORITY로 변경.
+   정책이나 우선순위가 잘못되었으면 false 반환.
+   SCHED_DEADLINE은 thread_set_deadline() 사용 */
+bool
+thread_set_sched (struct thread *t, enum sched_policy policy, int priority) {
+	const struct sched_class *class;
+	enum intr_level old_level;
+
+	ASSERT (is_thread (t));
+
+	switch (policy) {
+		case SCHED_NORMAL:
+			class = normal_class;
+			break;
+		case SCHED_FIFO:
+		case SCHED_RR:
+			class = &rt_sched_class;
+			break;
+		case SCHED_IDLE:
+			class = &idle_sched_class;
+			break;
+		default:
+			return false;
 	}
-	//PDG 우선순위 변경시 리스트 재정렬 end
+	if (priority < PRI_MIN || priority > PRI_MAX || t == idle_thread)
+		return false;
+
+	old_level = intr_disable ();
+	if (t->status == THREAD_READY)
+		t->sched_class->dequeue (t);
+	sched_change_class (t, policy, class);
+	t->org_priority = priority;
+	/* 받고 있는 donation이 더 높으면 유지 */
+	if (lock_max_donation (t) > priority)
+		priority = lock_max_donation (t);
+	t->priority = priority;
+	if (t->status == THREAD_READY)
+		t->sched_class->enqueue (t);
+	else if (t->waitq != NULL)
+		waitq_requeue (t);
+	intr_set_level (old_level);
+
+	priority_preemption ();
+	return true;
+}
+
+/* PDG T를 EDF 클래스(SCHED_DEADLINE)로 옮겨 PERIOD 틱마다 주기 시작
+   DEADLINE 틱 안에 RUNTIME 틱의 CPU를 보장.
+   인자가 잘못되었거나 승인 제어(sched_dl_bw_limit)에서 거절되면 false 반환 */
+bool
+thread_set_deadline (struct thread *t, int64_t runtime, int64_t deadline,
+		int64_t period) {
+	enum intr_level old_level;
+	bool success;
+
+	ASSERT (is_thread (t));
+
+	if (t == idle_thread)
+		return false;
+
+	old_level = intr_disable ();
+	if (t->status == THREAD_READY)
+		t->sched_class->dequeue (t);
+	success = sched_dl_admit (t, runtime, deadline, period);
+	if (success)
+		sched_change_class (t, SCHED_DEADLINE, &dl_sched_class);
+	if (t->status == THREAD_READY)
+		t->sched_class->enqueue (t);
+	intr_set_level (old_level);
+
+	priority_preemption ();
+	return success;
 }
 
 /* Returns the current thread's priority. */
@@ -480,10 +685,10 @@ thread_set_nice (int new_nice) {
 	/* TODO: Your implementation goes here */
 	enum intr_level old_level;
 	old_level = intr_disable ();
-	if(new_nice > 20)
-		thread_current()->nice = 20;
-	if(new_nice < -20)
-		thread_current()->nice = -20;
+	if(new_nice > NICE_MAX)
+		thread_current()->nice = NICE_MAX;
+	else if(new_nice < NICE_MIN)
+		thread_current()->nice = NICE_MIN;
 	else
 		thread_current()->nice = new_nice;
 	mlfqs_priority(thread_current());
@@ -524,52 +729,133 @@ thread_get_recent_cpu (void) {
 	return cur_recent_cpu;
 }
 
-/* PDG MLFQ 함수 추가 */
-void 
-mlfqs_recalc(){
-	struct list_elem *cur = list_front(&all_list);
-	struct thread * cur_thread;
-	
+/* PDG MLFQ 클래스 clock: 매 틱 타이머 인터럽트에서 호출 */
+static void
+mlfqs_clock (void) {
+	int64_t now = timer_ticks ();
+
+	mlfqs_increment();
+	/* 해당 부분 100틱 4틱 우선 순위 체크 필요 */
+	if (now % TIMER_FREQ == 0) {
+		mlfqs_recalc_due++;
+		softirq_raise (&mlfqs_work);
+	} else if (now % 4 == 0)
+		mlfqs_priority(thread_current());
+}
+
+/* PDG mlfqs_work의 softirq 함수. 밀린 1초 재계산을 모두 실행 */
+static void
+mlfqs_recalc_work (void *aux UNUSED) {
+	for (;;) {
+		enum intr_level old_level = intr_disable ();
+		bool due = mlfqs_recalc_due > 0;
+
+		if (due)
+			mlfqs_recalc_due--;
+		intr_set_level (old_level);
+		if (!due)
+			break;
+		mlfqs_recalc ();
+	}
+}
+
+/* PDG MLFQ 1초마다 softirq에서 호출.
+   load_avg와 감쇠 계수를 한번 계산하고, 실행중/ready 스레드만 갱신.
+   우선순위 구간이 바뀐 스레드만 다른 큐로 옮겨짐.
+   우선순위 큐 하나를 다 돌 때마다 인터럽트를 잠깐 허용해서 ready 스레드가
+   많아도 인터럽트가 꺼진 시간은 큐 하나 분량으로 제한. 그 사이에 큐에
+   들어온 스레드는 mlfqs_enqueue()가 밀린 감쇠를 반영하므로 빠지는 스레드 없음 */
+static void 
+mlfqs_recalc(void){
+	struct thread *curr = thread_current ();
 	enum intr_level old_level;
+	int pri;
+
 	old_level = intr_disable ();
 	mlfqs_load_avg();
-	while(list_end(&all_list) != cur){
-		cur_thread = list_entry(cur, struct thread, a_elem);
-		mlfqs_recent_cpu(cur_thread);
-		mlfqs_priority(cur_thread);
-		cur = cur->next;
+	decay_hist[mlfqs_epoch % DECAY_HIST] =
+		FIXED_DIVIDE(load_avg*2, FIXED_ADD_INT(load_avg * 2, 1));
+	mlfqs_epoch++;
+
+	mlfqs_refresh(curr);
+	for (pri = PRI_MAX; pri >= PRI_MIN; pri--) {
+		struct list_elem *e;
+
+		if (!(normal_rq.bitmap & (1ULL << pri)))
+			continue;
+		/* 옮겨진 스레드를 다시 만나도 이미 최신이라 아무 일도 없음 */
+		e = list_begin (&normal_rq.queue[pri]);
+		while (e != list_end (&normal_rq.queue[pri])) {
+			struct thread *t = list_entry (e, struct thread, elem);
+			e = list_next (e);
+			mlfqs_refresh (t);
+		}
+		intr_set_level (old_level);
+		intr_disable ();
 	}
-	list_sort(&all_list, compare_priority, NULL);
 	intr_set_level (old_level);
 }
 
-void
+/* PDG recent_cpu와 nice로 MLFQ 우선순위 계산 */
+static int
+mlfqs_calc_priority(struct thread *t){
+	int priority = PRI_MAX - FIXED_TO_INT(FIXED_DIVIDE_INT(t->recent_cpu, 4)) - (t->nice*2);
+	if (priority > PRI_MAX)
+		priority = PRI_MAX;
+	if (priority < PRI_MIN)
+		priority = PRI_MIN;
+	return priority;
+}
+
+/* PDG MLFQS 클래스 스레드만 MLFQ 우선순위 적용, RT/idle 클래스는 고정 */
+static void
 mlfqs_priority(struct thread *t){
-	if(t==idle_thread)
+	if(t==idle_thread || t->sched_class != &mlfqs_sched_class)
 		return;
-	t->priority = PRI_MAX - FIXED_TO_INT(FIXED_DIVIDE_INT(t->recent_cpu, 4)) - (t->nice*2);
+	thread_update_priority(t, mlfqs_calc_priority(t));
 }
 
-void
-mlfqs_recent_cpu(struct thread *t){
-	if(t==idle_thread)
+/* PDG T의 recent_cpu에 밀린 초만큼 감쇠 적용.
+   기록보다 오래 밀렸으면 가장 오래된 계수로 값이 수렴할 때까지 근사 */
+static void
+mlfqs_catch_up(struct thread *t){
+	while (t->mlfqs_epoch < mlfqs_epoch) {
+		int64_t epoch = t->mlfqs_epoch;
+		int old_recent_cpu = t->recent_cpu;
+
+		if (mlfqs_epoch - epoch > DECAY_HIST)
+			epoch = mlfqs_epoch - DECAY_HIST;
+		t->recent_cpu = FIXED_ADD_INT(FIXED_MULTIPLY(decay_hist[epoch % DECAY_HIST], t->recent_cpu), t->nice);
+
+		if (epoch != t->mlfqs_epoch && t->recent_cpu == old_recent_cpu)
+			t->mlfqs_epoch = epoch + 1;
+		else
+			t->mlfqs_epoch++;
+	}
+}
+
+/* PDG 감쇠 반영 후 우선순위 재계산 */
+static void
+mlfqs_refresh(struct thread *t){
+	if(t==idle_thread || t->sched_class != &mlfqs_sched_class)
 		return;
-	t->recent_cpu = FIXED_ADD_INT(FIXED_MULTIPLY(FIXED_DIVIDE(load_avg*2,(FIXED_ADD_INT(load_avg * 2,1))),t->recent_cpu), t->nice);
+	mlfqs_catch_up(t);
+	mlfqs_priority(t);
 }
 
-void 
+static void
 mlfqs_load_avg(void){
 	int ready_threads;
 	if(thread_current() == idle_thread)
-		ready_threads = list_size(&ready_list);
+		ready_threads = ready_cnt;
 	else
-		ready_threads = list_size(&ready_list)+1;
+		ready_threads = ready_cnt + 1;
 	load_avg = FIXED_ADD(FIXED_MULTIPLY(load_avg, (INT_TO_FIXED(59)/60)),FIXED_MULTIPLY_INT(INT_TO_FIXED(1)/60, ready_threads));
 }
 
-void
+static void
 mlfqs_increment(void){
-	if(thread_current()==idle_thread)
+	if(thread_current()==idle_thread || thread_current()->sched_class != &mlfqs_sched_class)
 		return;
 	thread_current()->recent_cpu = FIXED_ADD_INT(thread_current()->recent_cpu,1);
 }
@@ -593,8 +879,18 @@ idle (void *idle_started_ UNUSED) {
 	for (;;) {
 		/* Let someone else run. */
 		intr_disable ();
+		/* PDG one-shot 도중 다른 인터럽트로 깨어났다면 틱 보정 */
+		timer_idle_exit ();
 		thread_block ();
 
+		/* PDG 실행할 스레드가 없는 동안 PAL_ZERO용 페이지를 미리 0으로 채움.
+		   그 사이 깨어난 스레드가 있으면 인터럽트 복귀 시 양보됨 */
+		while (palloc_zero_idle ())
+			continue;
+
+		/* PDG tickless 모드면 다음 타이머 만료까지 주기 틱을 멈춤 */
+		timer_idle_enter ();
+
 		/* Re-enable interrupts and wait for the next one.
 
 		   The `sti' instruction disables interrupts until the
@@ -607,6 +903,9 @@ idle (void *idle_started_ UNUSED) {
 
 		   See [IA32-v2a] "HLT", [IA32-v2b] "STI", and [IA32-v3a]
 		   7.11.1 "HLT Instruction". */
+		/* PDG irqsoff 추적기에 인터럽트가 켜지는 지점을 알림 */
+		if (irqsoff_enabled)
+			irqsoff_end (idle);
 		asm volatile ("sti; hlt" : : : "memory");
 	}
 }
@@ -633,21 +932,22 @@ init_thread (struct thread *t, const char *name, int priority) {
 	memset (t, 0, sizeof *t);
 	t->status = THREAD_BLOCKED;
 	strlcpy (t->name, name, sizeof t->name);
-	t->tf.rsp = (uint64_t) t + PGSIZE - sizeof (void *);
+	t->tf.rsp = (uint64_t) thread_stack_top (t) - sizeof (void *);
 	t->priority = priority;
 	t->org_priority = priority;
+	/* PDG 새 스레드는 항상 SCHED_NORMAL로 시작 */
+	t->policy = SCHED_NORMAL;
+	t->sched_class = normal_class;
 	
-	list_init(&t->donation);
+	list_init(&t->held_locks);
 	/* PDG MLFQ 친절함 초기화 */
 	t->nice = NICE_DEFAULT;
 	/* PDG MLFQ CPU 사용량 초기화 */
 	t->recent_cpu = RECENT_CPU_DEFAULT;
+	t->mlfqs_epoch = mlfqs_epoch;
 
 	/* PDG project2 자식 리스트 초기화 */
 	list_init(&t->child_list);
-	/* PDG project2 자식 리스트 초기화 */
-	t->next_fd = 2;
-	
 	t->magic = THREAD_MAGIC;	
 }
 
@@ -658,10 +958,270 @@ init_thread (struct thread *t, const char *name, int priority) {
    idle_thread. */
 static struct thread *
 next_thread_to_run (void) {
-	if (list_empty (&ready_list))
-		return idle_thread;
+	//PDG rank 순서로 클래스에 물어보고 모두 비어있으면 idle
+	for (int i = 0; i < sched_class_cnt; i++) {
+		struct thread *t = sched_classes[i]->pick_next ();
+		if (t != NULL) {
+			ready_cnt--;
+			return t;
+		}
+	}
+	return idle_thread;
+}
+
+/* PDG 새 스레드 블록 할당. 캐시에 회수된 블록이 있으면 그대로 사용.
+   없으면 정렬된 블록을 얻기 위해 블록 두배 가까이 할당한 뒤 정렬된 부분의
+   struct thread, 가드, 스택 페이지만 남기고 반환하고 가드 페이지는 매핑 해제.
+   어느 쪽이든 0으로 채우지 않음, struct thread는 init_thread()가 채움 */
+static struct thread *
+thread_alloc (void) {
+	size_t block_pages = thread_block_size / PGSIZE;
+	size_t used_pages = 2 + thread_stack_pages;
+	size_t alloc_pages = 2 * block_pages - 1;
+	uint8_t *alloc, *base;
+	enum intr_level old_level;
+	size_t head;
+
+	old_level = intr_disable ();
+	if (!list_empty (&thread_cache)) {
+		struct thread *t =
+			list_entry (list_pop_front (&thread_cache), struct thread, elem);
+		thread_cache_cnt--;
+		intr_set_level (old_level);
+		return t;
+	}
+	intr_set_level (old_level);
+
+	alloc = palloc_get_multiple (0, alloc_pages);
+	if (alloc == NULL)
+		return NULL;
+	base = (uint8_t *) ROUND_UP ((uint64_t) alloc, thread_block_size);
+	head = (base - alloc) / PGSIZE;
+	palloc_free_multiple (alloc, head);
+	palloc_free_multiple (base + used_pages * PGSIZE,
+			alloc_pages - head - used_pages);
+
+	set_guard (base + PGSIZE, false);
+	return (struct thread *) base;
+}
+
+/* PDG 종료된 스레드 T의 블록을 캐시에 넣고, 캐시가 가득 찼으면 반환.
+   인터럽트가 꺼진 상태에서 호출 */
+static void
+thread_recycle (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	if (thread_cache_cnt < thread_cache_max) {
+		list_push_front (&thread_cache, &t->elem);
+		thread_cache_cnt++;
+	} else
+		thread_free (t);
+}
+
+/* PDG thread_alloc()으로 할당한 T의 블록 반환 */
+static void
+thread_free (struct thread *t) {
+	set_guard ((uint8_t *) t + PGSIZE, true);
+	palloc_free_multiple (t, 2 + thread_stack_pages);
+}
+
+/* PDG 캐시에 보관 중인 스레드 블록을 모두 palloc에 돌려줌.
+   커널 풀 할당이 실패했을 때 palloc이 호출. 하나라도 돌려줬으면 true */
+bool
+thread_cache_reclaim (void) {
+	bool freed = false;
+
+	for (;;) {
+		struct thread *t = NULL;
+		enum intr_level old_level = intr_disable ();
+
+		if (!list_empty (&thread_cache)) {
+			t = list_entry (list_pop_front (&thread_cache), struct thread, elem);
+			thread_cache_cnt--;
+		}
+		intr_set_level (old_level);
+		if (t == NULL)
+			return freed;
+		thread_free (t);
+		freed = true;
+	}
+}
+
+/* PDG 커널 페이지 테이블에서 PAGE의 매핑을 켜거나 끔.
+   유저 pml4는 커널 영역 하위 테이블을 공유하므로 모든 주소 공간에 반영됨 */
+static void
+set_guard (void *page, bool present) {
+	uint64_t *pte = pml4e_walk (base_pml4, (uint64_t) page, 0);
+
+	ASSERT (pte != NULL);
+	if (present)
+		*pte |= PTE_P;
 	else
-		return list_entry (list_pop_front (&ready_list), struct thread, elem);
+		*pte &= ~(uint64_t) PTE_P;
+	invlpg ((uint64_t) page);
+}
+
+/* Returns the address just above T's kernel stack. */
+void *
+thread_stack_top (struct thread *t) {
+	if (t == initial_thread)
+		return (uint8_t *) t + PGSIZE;
+	return (uint8_t *) t + (2 + thread_stack_pages) * PGSIZE;
+}
+
+/* If VA lies in the guard page below some thread's kernel stack,
+   returns that thread; otherwise, returns a null pointer.  Used
+   to recognize kernel stack overflows in fault handlers. */
+struct thread *
+thread_guard_owner (const void *va) {
+	struct thread *t;
+	uint64_t *pte;
+
+	if (!is_kernel_vaddr (va))
+		return NULL;
+	t = (struct thread *) ((uint64_t) va & ~(thread_block_size - 1));
+	if (t == initial_thread || pg_round_down (va) != (uint8_t *) t + PGSIZE)
+		return NULL;
+	pte = pml4e_walk (base_pml4, (uint64_t) t, 0);
+	if (pte == NULL || !(*pte & PTE_P) || !is_thread (t))
+		return NULL;
+	return t;
+}
+
+/* PDG T를 자신의 클래스 run 큐에 추가.
+   인터럽트가 꺼진 상태에서 호출해야 함 */
+static void
+sched_enqueue (struct thread *t) {
+	ASSERT (intr_get_level () == INTR_OFF);
+	t->sched_class->enqueue (t);
+	ready_cnt++;
+}
+
+/* PDG T를 CLASS로 옮김. 클래스가 바뀌면 이전 클래스의 detach와
+   새 클래스의 attach 호출.
+   인터럽트가 꺼지고 T가 run 큐에 없는 상태에서 호출해야 함 */
+static void
+sched_change_class (struct thread *t, enum sched_policy policy,
+		const struct sched_class *class) {
+	const struct sched_class *old = t->sched_class;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+	if (old != class && old->detach != NULL)
+		old->detach (t);
+	t->policy = policy;
+	t->sched_class = class;
+	if (old != class && class->attach != NULL)
+		class->attach (t);
+}
+
+/* PDG 실행중인 CURR보다 먼저 실행되어야 할 ready 스레드가 있는지.
+   CURR 클래스보다 rank가 높지 않은 클래스에만 물어봄 */
+static bool
+sched_need_resched (struct thread *curr) {
+	if (curr == idle_thread)
+		return ready_cnt != 0;
+	for (int i = 0; i < sched_class_cnt; i++) {
+		const struct sched_class *class = sched_classes[i];
+
+		if (class->rank > curr->sched_class->rank)
+			break;
+		if (class->preempt_check (curr))
+			return true;
+	}
+	return false;
+}
+
+/* PDG normal 클래스 (우선순위 스케줄링 / MLFQS) 연산 */
+static void
+normal_init (void) {
+	prio_rq_init (&normal_rq);
+}
+
+static void
+normal_enqueue (struct thread *t) {
+	prio_rq_push (&normal_rq, t);
+}
+
+static void
+normal_dequeue (struct thread *t) {
+	prio_rq_remove (&normal_rq, t);
+}
+
+static struct thread *
+normal_pick_next (void) {
+	return normal_rq.cnt != 0 ? prio_rq_pop (&normal_rq) : NULL;
+}
+
+static bool
+normal_tick (struct thread *curr UNUSED, unsigned ran) {
+	return ran >= TIME_SLICE;
+}
+
+static bool
+normal_preempt_check (struct thread *curr) {
+	if (normal_rq.cnt == 0)
+		return false;
+	if (curr->sched_class != normal_class)
+		return true;
+	return prio_rq_max (&normal_rq) > curr->priority;
+}
+
+/* PDG MLFQ: 1초 경계를 넘겨 잤다면 밀린 recent_cpu 감쇠와 우선순위를
+   반영한 뒤 큐에 추가 */
+static void
+mlfqs_enqueue (struct thread *t) {
+	if (t != idle_thread && t->mlfqs_epoch != mlfqs_epoch) {
+		mlfqs_catch_up (t);
+		t->priority = mlfqs_calc_priority (t);
+	}
+	prio_rq_push (&normal_rq, t);
+}
+
+static const struct sched_class prio_sched_class = {
+	.name = "normal",
+	.rank = SCHED_RANK_NORMAL,
+	.priority_donation = true,
+	.init = normal_init,
+	.enqueue = normal_enqueue,
+	.dequeue = normal_dequeue,
+	.pick_next = normal_pick_next,
+	.tick = normal_tick,
+	.yield = normal_enqueue,
+	.preempt_check = normal_preempt_check,
+};
+
+/* PDG MLFQS는 우선순위를 직접 계산하므로 donation 없음 */
+static const struct sched_class mlfqs_sched_class = {
+	.name = "mlfqs",
+	.rank = SCHED_RANK_NORMAL,
+	.priority_donation = false,
+	.init = normal_init,
+	.enqueue = mlfqs_enqueue,
+	.dequeue = normal_dequeue,
+	.pick_next = normal_pick_next,
+	.tick = normal_tick,
+	.yield = mlfqs_enqueue,
+	.preempt_check = normal_preempt_check,
+	.clock = mlfqs_clock,
+};
+
+/* PDG T의 (donation 포함) 현재 우선순위를 PRIORITY로 변경.
+   T가 ready 상태라면 새 우선순위 큐로, 대기 큐에 있다면 새 위치로 옮겨줌 */
+void
+thread_update_priority (struct thread *t, int priority) {
+	enum intr_level old_level = intr_disable ();
+
+	if (t->priority != priority) {
+		if (t->status == THREAD_READY) {
+			t->sched_class->dequeue (t);
+			t->priority = priority;
+			t->sched_class->enqueue (t);
+		} else {
+			t->priority = priority;
+			if (t->waitq != NULL)
+				waitq_requeue (t);
+		}
+	}
+	intr_set_level (old_level);
 }
 
 /* Use iretq to launch the thread */
@@ -772,7 +1332,7 @@ do_schedule(int status) {
 	while (!list_empty (&destruction_req)) {
 		struct thread *victim =
 			list_entry (list_pop_front (&destruction_req), struct thread, elem);
-		palloc_free_page(victim);
+		thread_recycle (victim);
 	}
 	thread_current ()->status = status;
 	schedule ();
@@ -792,6 +1352,9 @@ schedule (void) {
 	/* Start new time slice. */
 	thread_ticks = 0;
 
+	/* PDG 나가는 스레드가 쓴 CPU 시간 계산 */
+	account_cpu_time (curr);
+
 #ifdef USERPROG
 	/* Activate the new address space. */
 	process_activate (next);
@@ -810,9 +1373,13 @@ schedule (void) {
 			list_push_back (&destruction_req, &curr->elem);
 		}
 
-		/* Before switching the thread, we first save the information
-		 * of current running. */
-		thread_launch (next);
+		/* PDG 커널 스레드끼리는 callee-saved 레지스터와 rsp만 교환.
+		   intr_frame 전체 저장 + iretq는 첫 진입(switch_entry)과
+		   유저 모드 복귀에만 사용 */
+		if (thread_iret_switch)
+			thread_launch (next);
+		else
+			switch_threads (curr, next);
 	}
 }
 
@@ -0,0 +1,261 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Deferred work.
+
+   Softirq work is queued on softirq_queue, which has no workers.
+   When the outermost external interrupt handler returns,
+   intr_handler() calls softirq_run(), which runs the queued work
+   with interrupts on, still in the interrupted thread's context.
+   intr_context() stays true meanwhile, so softirq work must not
+   sleep, but other interrupts can come in.  Work raised from an
+   interrupt handler while softirq work runs is picked up by the
+   same softirq_run().
+
+   Workqueue work runs in the queue's worker threads, which sleep
+   while the queue is empty.  Work may sleep there, and the
+   workers' priority decides how it competes with other threads.
+
+   A work item is pending from when it is queued until it starts
+   to run, and queueing it again meanwhile has no effect.  Once it
+   starts it can be queued again, so one item may run again, even
+   on another worker, before an earlier run is over. */
+
+/* A worker thread waiting for work. */
+struct worker {
+	struct list_elem elem;      /* Element in workqueue's idle list. */
+	struct thread *thread;      /* The worker. */
+};
+
+/* A thread waiting in flush_work(). */
+struct flusher {
+	struct list_elem elem;      /* Element in workqueue's flushers. */
+	struct work *work;          /* Work waited for. */
+	struct semaphore done;      /* Upped when WORK is idle. */
+};
+
+static struct workqueue softirq_queue;
+
+static void workqueue_init_queue (struct workqueue *, const char *name);
+static struct work *dequeue_work (struct workqueue *);
+static void finish_work (struct work *);
+static thread_func worker_main NO_RETURN;
+
+/* Initializes the softirq queue.  Must be called before any
+   interrupt handler raises a softirq. */
+void
+workqueue_init (void) {
+	workqueue_init_queue (&softirq_queue, "softirq");
+}
+
+/* Initializes work item W to call FUNC, passing AUX. */
+void
+work_init (struct work *w, work_func *func, void *aux) {
+	ASSERT (w != NULL);
+	ASSERT (func != NULL);
+
+	w->func = func;
+	w->aux = aux;
+	w->wq = NULL;
+	w->pending = false;
+	w->running = 0;
+}
+
+/* Creates a workqueue named NAME with WORKERS worker threads at
+   PRIORITY.  Returns the new workqueue, or a null pointer if
+   memory or a thread cannot be allocated.  Workqueues live
+   forever. */
+struct workqueue *
+workqueue_create (const char *name, int priority, size_t workers) {
+	struct workqueue *wq;
+	size_t i;
+
+	ASSERT (workers > 0);
+
+	wq = malloc (sizeof *wq);
+	if (wq == NULL)
+		return NULL;
+	workqueue_init_queue (wq, name);
+
+	for (i = 0; i < workers; i++)
+		if (thread_create (wq->name, priority, worker_main, wq) == TID_ERROR) {
+			/* Workers that already started stay, idle, but the
+			   queue is never handed out. */
+			if (i == 0)
+				free (wq);
+			return NULL;
+		}
+	return wq;
+}
+
+/* Queues W on WQ, waking up a worker if one is idle.  Returns
+   true if W was queued, false if it was already pending.
+
+   May be called from an interrupt handler. */
+bool
+queue_work (struct workqueue *wq, struct work *w) {
+	enum intr_level old_level;
+
+	ASSERT (wq != NULL);
+	ASSERT (w != NULL);
+
+	old_level = intr_disable ();
+	if (w->pending) {
+		intr_set_level (old_level);
+		return false;
+	}
+	w->pending = true;
+	w->wq = wq;
+	list_push_back (&wq->pending, &w->elem);
+	if (!list_empty (&wq->idle)) {
+		struct worker *worker =
+			list_entry (list_pop_front (&wq->idle), struct worker, elem);
+		thread_wake (worker->thread);
+		priority_preemption ();
+	}
+	intr_set_level (old_level);
+	return true;
+}
+
+/* Queues W to run with interrupts on when the current external
+   interrupt returns.  Returns true if W was queued, false if it
+   was already pending.
+
+   Outside an interrupt handler, runs W, and any other pending
+   softirq work, right away if interrupts are on, and otherwise
+   leaves it for the next interrupt. */
+bool
+softirq_raise (struct work *w) {
+	enum intr_level old_level;
+
+	if (!queue_work (&softirq_queue, w))
+		return false;
+	if (!intr_context () && intr_get_level () == INTR_ON) {
+		old_level = intr_disable ();
+		softirq_run ();
+		intr_set_level (old_level);
+	}
+	return true;
+}
+
+/* Runs pending softirq work, with interrupts on, until there is
+   none left.  Called by intr_handler() at the end of an external
+   interrupt, or by softirq_raise(), with interrupts off, and
+   returns with interrupts off. */
+void
+softirq_run (void) {
+	struct work *w;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	while ((w = dequeue_work (&softirq_queue)) != NULL) {
+		intr_enable ();
+		w->func (w->aux);
+		intr_disable ();
+		finish_work (w);
+	}
+}
+
+/* Waits until W is neither pending nor running.  W must not be
+   queued again meanwhile, or this may wait for that run too.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler or from W itself. */
+void
+flush_work (struct work *w) {
+	struct flusher f;
+	enum intr_level old_level;
+
+	ASSERT (w != NULL);
+	ASSERT (!intr_context ());
+
+	old_level = intr_disable ();
+	if (!w->pending && w->running == 0) {
+		intr_set_level (old_level);
+		return;
+	}
+	f.work = w;
+	sema_init (&f.done, 0);
+	list_push_back (&w->wq->flushers, &f.elem);
+	intr_set_level (old_level);
+
+	sema_down (&f.done);
+}
+
+/* Initializes WQ, named NAME, with no workers. */
+static void
+workqueue_init_queue (struct workqueue *wq, const char *name) {
+	strlcpy (wq->name, name, sizeof wq->name);
+	list_init (&wq->pending);
+	list_init (&wq->idle);
+	list_init (&wq->flushers);
+}
+
+/* Removes the first pending work from WQ and marks it running.
+   Returns a null pointer if WQ has none. */
+static struct work *
+dequeue_work (struct workqueue *wq) {
+	struct work *w;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	if (list_empty (&wq->pending))
+		return NULL;
+	w = list_entry (list_pop_front (&wq->pending), struct work, elem);
+	w->pending = false;
+	w->running++;
+	return w;
+}
+
+/* Marks one run of W over and, if that leaves W idle, releases
+   the threads waiting for it in flush_work(). */
+static void
+finish_work (struct work *w) {
+	struct list *flushers = &w->wq->flushers;
+	struct list_elem *e;
+
+	ASSERT (intr_get_level () == INTR_OFF);
+
+	w->running--;
+	if (w->pending || w->running != 0)
+		return;
+	for (e = list_begin (flushers); e != list_end (flushers); ) {
+		struct flusher *f = list_entry (e, struct flusher, elem);
+
+		e = list_next (e);
+		if (f->work == w) {
+			list_remove (&f->elem);
+			sema_up (&f->done);
+		}
+	}
+}
+
+/* A worker thread of the workqueue WQ_: runs pending work in
+   order, and sleeps while there is none. */
+static void
+worker_main (void *wq_) {
+	struct workqueue *wq = wq_;
+	struct worker self;
+
+	self.thread = thread_current ();
+	intr_disable ();
+	for (;;) {
+		struct work *w = dequeue_work (wq);
+
+		if (w == NULL) {
+			list_push_back (&wq->idle, &self.elem);
+			thread_block ();
+			continue;
+		}
+		intr_enable ();
+		w->func (w->aux);
+		intr_disable ();
+		finish_work (w);
+	}
+}
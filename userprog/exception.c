@@ -2,6 +2,7 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
+#include "userprog/tss.h"
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "intrinsic.h"
@@ -11,6 +12,7 @@ static long long page_fault_cnt;
 
 static void kill (struct intr_frame *);
 static void page_fault (struct intr_frame *);
+static void double_fault (struct intr_frame *);
 
 /* Registers handlers for interrupts that can be caused by user
    programs.
@@ -58,6 +60,13 @@ exception_init (void) {
 	   We need to disable interrupts for page faults because the
 	   fault address is stored in CR2 and needs to be preserved. */
 	intr_register_int (14, 0, INTR_OFF, page_fault, "#PF Page-Fault Exception");
+
+	/* A double fault usually means that the kernel stack overflowed
+	   into its guard page, so that the CPU could not push the
+	   page fault's frame.  Handle it on a stack of its own. */
+	intr_register_int (8, 0, INTR_OFF, double_fault,
+			"#DF Double Fault Exception");
+	intr_set_ist (8, TSS_IST_DF);
 }
 
 /* Prints exception statistics. */
@@ -130,6 +139,11 @@ page_fault (struct intr_frame *f) {
 
 	fault_addr = (void *) rcr2();
 
+	/* PDG 커널 스택이 가드 페이지를 침범 */
+	if (!(f->error_code & PF_U) && thread_guard_owner (fault_addr) != NULL)
+		PANIC ("Kernel stack overflow in thread `%s'",
+				thread_guard_owner (fault_addr)->name);
+
 	/* Turn interrupts back on (they were only off so that we could
 	   be assured of reading CR2 before it changed). */
 	intr_enable ();
@@ -161,3 +175,14 @@ page_fault (struct intr_frame *f) {
 	kill (f);
 }
 
+/* Double fault handler.  Runs on the TSS_IST_DF stack, because
+   the interrupted stack may be unusable. */
+static void
+double_fault (struct intr_frame *f) {
+	struct thread *t = thread_guard_owner ((void *) rcr2 ());
+
+	if (t != NULL)
+		PANIC ("Kernel stack overflow in thread `%s'", t->name);
+	intr_dump_frame (f);
+	PANIC ("Double fault");
+}
@@ -0,0 +1,135 @@
+#include "userprog/fdtable.h"
+#include <debug.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+
+/* Number of descriptors a new table has room for. */
+#define FD_INIT_SIZE 16
+
+/* Creates and returns a new, empty descriptor table, or a null
+   pointer if memory is not available. */
+struct fd_table *
+fd_table_create (void) {
+	struct fd_table *fdt = malloc (sizeof *fdt);
+
+	if (fdt == NULL)
+		return NULL;
+	fdt->files = calloc (FD_INIT_SIZE, sizeof *fdt->files);
+	if (fdt->files == NULL) {
+		free (fdt);
+		return NULL;
+	}
+	fdt->size = FD_INIT_SIZE;
+	fdt->next_fd = FD_MIN;
+	return fdt;
+}
+
+/* Returns a copy of SRC in which every open file is duplicated
+   with file_duplicate(), as fork() requires, or a null pointer
+   if memory is not available. */
+struct fd_table *
+fd_table_duplicate (const struct fd_table *src) {
+	struct fd_table *fdt = malloc (sizeof *fdt);
+	int fd;
+
+	if (fdt == NULL)
+		return NULL;
+	fdt->files = calloc (src->size, sizeof *fdt->files);
+	if (fdt->files == NULL) {
+		free (fdt);
+		return NULL;
+	}
+	fdt->size = src->size;
+	fdt->next_fd = src->next_fd;
+
+	for (fd = FD_MIN; fd < src->size; fd++) {
+		if (src->files[fd] == NULL)
+			continue;
+		fdt->files[fd] = file_duplicate (src->files[fd]);
+		if (fdt->files[fd] == NULL) {
+			fd_table_destroy (fdt);
+			return NULL;
+		}
+	}
+	return fdt;
+}
+
+/* Closes every file open in FDT and frees it.  FDT may be a null
+   pointer, in which case this does nothing. */
+void
+fd_table_destroy (struct fd_table *fdt) {
+	int fd;
+
+	if (fdt == NULL)
+		return;
+	for (fd = FD_MIN; fd < fdt->size; fd++)
+		file_close (fdt->files[fd]);
+	free (fdt->files);
+	free (fdt);
+}
+
+/* Grows FDT so that it can hold at least descriptor FD.  Returns
+   false if memory is not available. */
+static bool
+grow (struct fd_table *fdt, int fd) {
+	int size = fdt->size;
+	struct file **files;
+
+	while (size <= fd)
+		size *= 2;
+	if (size > FD_MAX)
+		size = FD_MAX;
+
+	files = realloc (fdt->files, size * sizeof *files);
+	if (files == NULL)
+		return false;
+	memset (files + fdt->size, 0, (size - fdt->size) * sizeof *files);
+	fdt->files = files;
+	fdt->size = size;
+	return true;
+}
+
+/* Installs FILE in FDT at the lowest free descriptor and returns
+   it, or returns -1 if FDT is full or cannot grow. */
+int
+fd_table_install (struct fd_table *fdt, struct file *file) {
+	int fd;
+
+	ASSERT (file != NULL);
+
+	for (fd = fdt->next_fd; fd < fdt->size; fd++)
+		if (fdt->files[fd] == NULL)
+			break;
+	if (fd >= FD_MAX || (fd >= fdt->size && !grow (fdt, fd)))
+		return -1;
+
+	fdt->files[fd] = file;
+	fdt->next_fd = fd + 1;
+	return fd;
+}
+
+/* Returns the file open as FD in FDT, or a null pointer if FD is
+   not open.  FDT may be a null pointer, meaning that no file has
+   been opened yet. */
+struct file *
+fd_table_get (const struct fd_table *fdt, int fd) {
+	if (fdt == NULL || fd < FD_MIN || fd >= fdt->size)
+		return NULL;
+	return fdt->files[fd];
+}
+
+/* Removes FD from FDT and returns the file that was open as FD,
+   which the caller must close, or a null pointer if FD was not
+   open. */
+struct file *
+fd_table_remove (struct fd_table *fdt, int fd) {
+	struct file *file = fd_table_get (fdt, fd);
+
+	if (file != NULL) {
+		fdt->files[fd] = NULL;
+		if (fd < fdt->next_fd)
+			fdt->next_fd = fd;
+	}
+	return file;
+}
@@ -19,6 +19,7 @@
 #include "threads/vaddr.h"
 #include "intrinsic.h"
 #include "userprog/syscall.h"
+#include "userprog/fdtable.h"
 #ifdef VM
 #include "vm/vm.h"
 #endif
@@ -203,18 +204,13 @@ __do_fork(void *aux)
 	 * TODO:       부모는 이 함수가 부모의 리소스를 성공적으로 복제할 때까지 fork()에서 반환해서는 안 됩니다.*/
 	
 	/*PDG project2 fork test*/
-	// FDT 복제
-    for (int i = 0; i < MAX_FILES; i++)
+	// FDT 복제 (부모가 파일을 연 적이 있을 때만)
+    if (parent->fdt != NULL)
     {
-        struct file *file = parent->fdt[i];
-        if (file == NULL)
-            continue;
-        if (file > 2)
-            file = file_duplicate(file);
-        current->fdt[i] = file;
+        current->fdt = fd_table_duplicate(parent->fdt);
+        if (current->fdt == NULL)
+            goto error;
     }
-    // PDG next_fd도 복제
-    current->next_fd = parent->next_fd;
 	sema_up(&current->load_sema_info);
 	
 	process_init();
@@ -305,8 +301,8 @@ void process_exit(void)
 //	process_cleanup();
 //	sema_up(&curr->wait_sema_info);
 
-	for (int i = 2; i < MAX_FILES; i++)
-        close(i);
+	fd_table_destroy(curr->fdt);
+    curr->fdt = NULL;
  
     file_close(curr->running);
  
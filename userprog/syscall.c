@@ -10,8 +10,11 @@
 #include "lib/user/syscall.h"
 #include "include/filesys/filesys.h"
 #include "userprog/process.h"
+#include "userprog/fdtable.h"
 #include "lib/string.h"
 #include "threads/palloc.h"
+#include "threads/lockstat.h"
+#include "devices/hrtimer.h"
 
 void syscall_entry (void);
 void syscall_handler (struct intr_frame *);
@@ -33,7 +36,6 @@ pid_t sys_fork (const char *thread_name, struct intr_frame *f);
 #define MSR_STAR 0xc0000081         /* 세그먼트 선택자 msr */
 #define MSR_LSTAR 0xc0000082        /* Long mode SYSCALL target */
 #define MSR_SYSCALL_MASK 0xc0000084 /* eflags에 대한 마스크 */
-#define FDT_limit 128 /* eflags에 대한 마스크 */
 
 void
 syscall_init (void) {
@@ -115,6 +117,18 @@ syscall_handler (struct intr_frame *f UNUSED) {
         case SYS_CLOSE:
             close((int)arg1);
             break;
+        case SYS_SCHED_SETSCHEDULER:
+            f->R.rax = sched_setscheduler((int)arg1, (int)arg2);
+            break;
+        case SYS_SCHED_SETDEADLINE:
+            f->R.rax = sched_setdeadline((int64_t)arg1, (int64_t)arg2, (int64_t)arg3);
+            break;
+        case SYS_LOCKSTAT:
+            f->R.rax = lockstat((struct lockstat *)arg1, (int)arg2);
+            break;
+        case SYS_NANOSLEEP:
+            f->R.rax = nanosleep((int64_t)arg1);
+            break;
         default:
             exit(-1);
             thread_exit ();
@@ -269,30 +283,60 @@ void close(int fd) {
     process_remove_file(fd);
 }
 
+/* 현재 프로세스의 스케줄링 정책을 바꿈, 성공하면 0 실패하면 -1 */
+int sched_setscheduler(int policy, int priority) {
+    if (!thread_set_sched(thread_current(), policy, priority))
+        return -1;
+    return 0;
+}
+
+int sched_setdeadline(int64_t runtime, int64_t deadline, int64_t period) {
+    if (!thread_set_deadline(thread_current(), runtime, deadline, period))
+        return -1;
+    return 0;
+}
+
+/* PDG 락 통계를 최대 CNT개까지 BUF에 복사하고 전체 개수를 반환.
+   LOCKSTAT 없이 빌드된 커널이면 -1 */
+int lockstat(struct lockstat *buf, int cnt) {
+#ifdef LOCKSTAT
+    if (cnt < 0)
+        return -1;
+    if (cnt > 0) {
+        check_address(buf);
+        check_address(buf + cnt - 1);
+    }
+    return lockstat_copy(buf, cnt);
+#else
+    (void) buf;
+    (void) cnt;
+    return -1;
+#endif
+}
+
+/* PDG 최소 NS 나노초 동안 잠듦. 로컬 APIC 타이머가 있으면 틱보다 정밀 */
+int nanosleep(int64_t ns) {
+    if (ns < 0)
+        return -1;
+    hrtimer_sleep(ns);
+    return 0;
+}
+
+/* PDG fd 테이블은 처음 파일을 열 때 생성 */
 int allocate_fd(struct file *file) {
     struct thread *curr = thread_current();
-	struct file **fdt = curr->fdt;
 
-	while (curr->next_fd < FDT_limit && fdt[curr->next_fd])
-		curr->next_fd++;
-	if (curr->next_fd >= FDT_limit)
-		return -1;
-	fdt[curr->next_fd] = file;
-
-	return curr->next_fd;
+    if (curr->fdt == NULL) {
+        curr->fdt = fd_table_create();
+        if (curr->fdt == NULL)
+            return -1;
+    }
+    return fd_table_install(curr->fdt, file);
 }
 
 struct file *get_file_by_fd(int fd) {
-    struct thread *t = thread_current();
-    if (fd < 0 || fd >= MAX_FILES) {
-        return NULL;
-    }
-    return t->fdt[fd];
+    return fd_table_get(thread_current()->fdt, fd);
 }
 void process_remove_file(int fd) {
-    struct thread *t = thread_current();
-    if (fd < 2 || fd >= MAX_FILES || t->fdt[fd] == NULL) {
-    }
-    file_close(t->fdt[fd]);
-    t->fdt[fd] = NULL;
+    file_close(fd_table_remove(thread_current()->fdt, fd));
 }
\ No newline at end of file
@@ -56,6 +56,11 @@ tss_init (void) {
 	 * ones we initialize. */
 	tss = palloc_get_page (PAL_ASSERT | PAL_ZERO);
 	tss_update (thread_current ());
+
+	/* Double faults get a stack of their own, because the usual
+	   cause is a kernel stack that overflowed into its guard
+	   page. */
+	tss->ist1 = (uint64_t) palloc_get_page (PAL_ASSERT) + PGSIZE;
 }
 
 /* Returns the kernel TSS. */
@@ -70,5 +75,5 @@ tss_get (void) {
 void
 tss_update (struct thread *next) {
 	ASSERT (tss != NULL);
-	tss->rsp0 = (uint64_t) next + PGSIZE;
+	tss->rsp0 = (uint64_t) thread_stack_top (next);
 }